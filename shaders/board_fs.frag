@@ -11,6 +11,10 @@ const float squareSize = 1.0 / 8.0; // For a NxN square, squareSize = 1.0 / (N)
 uniform vec2 selectedCell; // (x, y) coordinates of the selected cell
 uniform bool isCellSelected; // Whether a cell is selected
 
+// Hanging pieces as a bitboard split in two halves (bit 0 = a8, bit 63 = h1)
+uniform uint hangingLow;
+uniform uint hangingHigh;
+
 void main()
 {
     // Calculate the position of the fragment in the chessboard grid
@@ -25,12 +29,21 @@ void main()
 
     // Highlight color
     vec4 highlightColor = vec4(0.2, 0.8, 0.2, 1.0); // Green highlight
+    vec4 hangingColor = vec4(0.8, 0.2, 0.2, 1.0);   // Red highlight
+
+    // Board index of the square, counted from a8 like the bitboards
+    uint square = uint((7.0 - gridPos.y) * 8.0 + gridPos.x);
+    uint hangingBits = square < 32u ? hangingLow >> square : hangingHigh >> (square - 32u);
 
     // Check if the current fragment is in the selected cell
     if (isCellSelected && gridPos == selectedCell)
     {
         FragColor = highlightColor; // Highlight the selected cell
     }
+    else if ((hangingBits & 1u) != 0u)
+    {
+        FragColor = hangingColor; // Highlight a hanging piece
+    }
     else
     {
         // Set the color based on the square
@@ -0,0 +1,182 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include <array>
+#include "Bitboard.h"
+#include "Piece.h"
+#include "Magic.h"
+
+namespace Attacks
+{
+    // Leaper tables are generated at compile time and end up in read-only data
+    typedef std::array<Bitboard, 64> SquareTable;
+
+    constexpr SquareTable makeKnightAttacks()
+    {
+        SquareTable table{};
+        for (int square = 0; square < 64; square++)
+        {
+            Bitboard b = BB::squareBB(square);
+            Bitboard l1 = BB::west(b), l2 = BB::west(l1);
+            Bitboard r1 = BB::east(b), r2 = BB::east(r1);
+            Bitboard h1 = l1 | r1, h2 = l2 | r2;
+            table[square] = (h1 << 16) | (h1 >> 16) | (h2 << 8) | (h2 >> 8);
+        }
+        return table;
+    }
+
+    constexpr SquareTable makeKingAttacks()
+    {
+        SquareTable table{};
+        for (int square = 0; square < 64; square++)
+        {
+            Bitboard b = BB::squareBB(square);
+            Bitboard row = b | BB::west(b) | BB::east(b);
+            table[square] = (row | BB::north(row) | BB::south(row)) ^ b;
+        }
+        return table;
+    }
+
+    /// @brief Pawn capture targets for one color (Piece::White or Piece::Black).
+    constexpr SquareTable makePawnAttacks(int color)
+    {
+        SquareTable table{};
+        for (int square = 0; square < 64; square++)
+        {
+            Bitboard b = BB::squareBB(square);
+            table[square] = color == Piece::White ? BB::northEast(b) | BB::northWest(b)
+                                                  : BB::southEast(b) | BB::southWest(b);
+        }
+        return table;
+    }
+
+    inline constexpr SquareTable KnightAttacks = makeKnightAttacks();
+    inline constexpr SquareTable KingAttacks = makeKingAttacks();
+    // Indexed by Piece::colorIndex, then square
+    inline constexpr SquareTable PawnAttacks[2] = {makePawnAttacks(Piece::White), makePawnAttacks(Piece::Black)};
+
+    typedef std::array<SquareTable, 64> SquarePairTable;
+
+    /// @brief Step (file, rank) from one square towards another if they share a rank, file
+    /// or diagonal; (0, 0) otherwise.
+    constexpr bool alignedStep(int from, int to, int &fileStep, int &rankStep)
+    {
+        int fileDelta = BB::fileOf(to) - BB::fileOf(from);
+        int rankDelta = BB::rankOf(to) - BB::rankOf(from);
+        fileStep = (fileDelta > 0) - (fileDelta < 0);
+        rankStep = (rankDelta > 0) - (rankDelta < 0);
+        bool aligned = from != to && (fileDelta == 0 || rankDelta == 0 || fileDelta == rankDelta || fileDelta == -rankDelta);
+        return aligned;
+    }
+
+    /// @brief Squares strictly between two aligned squares; empty if they are not aligned.
+    constexpr SquarePairTable makeBetween()
+    {
+        SquarePairTable table{};
+        for (int from = 0; from < 64; from++)
+        {
+            for (int to = 0; to < 64; to++)
+            {
+                int fileStep = 0, rankStep = 0;
+                if (!alignedStep(from, to, fileStep, rankStep))
+                    continue;
+                int file = BB::fileOf(from) + fileStep, rank = BB::rankOf(from) + rankStep;
+                for (int square = BB::makeSquare(file, rank); square != to; square = BB::makeSquare(file, rank))
+                {
+                    table[from][to] |= BB::squareBB(square);
+                    file += fileStep;
+                    rank += rankStep;
+                }
+            }
+        }
+        return table;
+    }
+
+    /// @brief Full board-edge-to-edge line through two aligned squares; empty if not aligned.
+    constexpr SquarePairTable makeLine()
+    {
+        SquarePairTable table{};
+        for (int from = 0; from < 64; from++)
+        {
+            for (int to = 0; to < 64; to++)
+            {
+                int fileStep = 0, rankStep = 0;
+                if (!alignedStep(from, to, fileStep, rankStep))
+                    continue;
+                table[from][to] = BB::squareBB(from);
+                for (int sign = -1; sign <= 1; sign += 2)
+                {
+                    int file = BB::fileOf(from) + sign * fileStep, rank = BB::rankOf(from) + sign * rankStep;
+                    for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += sign * fileStep, rank += sign * rankStep)
+                        table[from][to] |= BB::squareBB(BB::makeSquare(file, rank));
+                }
+            }
+        }
+        return table;
+    }
+
+    inline constexpr SquarePairTable Between = makeBetween();
+    inline constexpr SquarePairTable Line = makeLine();
+
+    static_assert(KnightAttacks[0] == 0x0000000000020400ULL, "knight on a8 attacks b6 and c7");
+    static_assert(KingAttacks[63] == 0x40C0000000000000ULL, "king on h1 attacks g1, g2 and h2");
+    static_assert(PawnAttacks[0][52] == 0x0000280000000000ULL, "white pawn on e2 attacks d3 and f3");
+    static_assert(Between[56][63] == 0x7E00000000000000ULL, "a1-h1 passes b1 to g1");
+    static_assert(Line[0][9] == 0x8040201008040201ULL, "a8 and b7 lie on the long diagonal");
+
+    /// @brief Fills the runtime slider tables. Must be called once before any move generation.
+    inline void init()
+    {
+        Magic::init();
+    }
+
+    inline Bitboard rookAttacks(int square, Bitboard occupied)
+    {
+        return Magic::rookAttacks(square, occupied);
+    }
+
+    inline Bitboard bishopAttacks(int square, Bitboard occupied)
+    {
+        return Magic::bishopAttacks(square, occupied);
+    }
+
+    inline Bitboard queenAttacks(int square, Bitboard occupied)
+    {
+        return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+    }
+
+    /// @brief Squares attacked by a knight, bishop, rook, queen or king on a square.
+    inline Bitboard pieceAttacks(int type, int square, Bitboard occupied)
+    {
+        switch (type)
+        {
+        case Piece::Knight:
+            return KnightAttacks[square];
+        case Piece::Bishop:
+            return bishopAttacks(square, occupied);
+        case Piece::Rook:
+            return rookAttacks(square, occupied);
+        case Piece::Queen:
+            return queenAttacks(square, occupied);
+        case Piece::King:
+            return KingAttacks[square];
+        default:
+            return BB::Empty;
+        }
+    }
+
+    /// @brief Squares attacked by a pawn of the given color (Piece::White or Piece::Black).
+    inline Bitboard pawnAttacks(int color, int square)
+    {
+        return PawnAttacks[Piece::colorIndex(color)][square];
+    }
+
+    /// @brief Squares attacked by a pawn of color Color, with the table picked at compile time.
+    template <int Color>
+    inline Bitboard pawnAttacks(int square)
+    {
+        return PawnAttacks[Piece::colorIndex(Color)][square];
+    }
+}
+
+#endif
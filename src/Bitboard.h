@@ -0,0 +1,146 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/// @brief 64-bit set of squares. Bit i corresponds to Board::Square[i], so
+/// bit 0 is a8, bit 7 is h8 and bit 63 is h1 (same layout as the mailbox).
+typedef uint64_t Bitboard;
+
+namespace BB
+{
+    constexpr Bitboard Empty = 0ULL;
+    constexpr Bitboard All   = ~0ULL;
+
+    // Files (columns) of the mailbox
+    constexpr Bitboard FileA = 0x0101010101010101ULL;
+    constexpr Bitboard FileB = FileA << 1;
+    constexpr Bitboard FileC = FileA << 2;
+    constexpr Bitboard FileD = FileA << 3;
+    constexpr Bitboard FileE = FileA << 4;
+    constexpr Bitboard FileF = FileA << 5;
+    constexpr Bitboard FileG = FileA << 6;
+    constexpr Bitboard FileH = FileA << 7;
+
+    // Ranks, rank 8 being the first row of the mailbox
+    constexpr Bitboard Rank8 = 0xFFULL;
+    constexpr Bitboard Rank7 = Rank8 << (8 * 1);
+    constexpr Bitboard Rank6 = Rank8 << (8 * 2);
+    constexpr Bitboard Rank5 = Rank8 << (8 * 3);
+    constexpr Bitboard Rank4 = Rank8 << (8 * 4);
+    constexpr Bitboard Rank3 = Rank8 << (8 * 5);
+    constexpr Bitboard Rank2 = Rank8 << (8 * 6);
+    constexpr Bitboard Rank1 = Rank8 << (8 * 7);
+
+    /// @brief Returns the bitboard with only the given square set.
+    constexpr Bitboard squareBB(int square)
+    {
+        return 1ULL << square;
+    }
+
+    /// @brief Returns the column of a square, 0 for the a-file.
+    constexpr int fileOf(int square)
+    {
+        return square & 7;
+    }
+
+    /// @brief Returns the chess rank of a square, 0 for rank 1 and 7 for rank 8.
+    constexpr int rankOf(int square)
+    {
+        return 7 - (square >> 3);
+    }
+
+    /// @brief Returns the square index for a file (0 = a) and a chess rank (0 = rank 1).
+    constexpr int makeSquare(int file, int rank)
+    {
+        return (7 - rank) * 8 + file;
+    }
+
+    constexpr Bitboard fileBB(int square)
+    {
+        return FileA << fileOf(square);
+    }
+
+    constexpr Bitboard rankBB(int square)
+    {
+        return Rank8 << (square & 56);
+    }
+
+    // Shifts by one step, dropping the squares that would wrap around a file edge
+    constexpr Bitboard north(Bitboard b) { return b >> 8; }
+    constexpr Bitboard south(Bitboard b) { return b << 8; }
+    constexpr Bitboard east(Bitboard b) { return (b << 1) & ~FileA; }
+    constexpr Bitboard west(Bitboard b) { return (b >> 1) & ~FileH; }
+    constexpr Bitboard northEast(Bitboard b) { return (b >> 7) & ~FileA; }
+    constexpr Bitboard northWest(Bitboard b) { return (b >> 9) & ~FileH; }
+    constexpr Bitboard southEast(Bitboard b) { return (b << 9) & ~FileA; }
+    constexpr Bitboard southWest(Bitboard b) { return (b << 7) & ~FileH; }
+
+    /// @brief Shift by a square index delta known at compile time (-8 is north, +1 is east),
+    /// so color-templated code can pick the pawn direction without branching.
+    template <int Step>
+    constexpr Bitboard shift(Bitboard b)
+    {
+        static_assert(Step == -8 || Step == 8 || Step == -7 || Step == -9 || Step == 9 || Step == 7, "not a pawn step");
+        return Step == -8  ? north(b)
+               : Step == 8 ? south(b)
+               : Step == -7 ? northEast(b)
+               : Step == -9 ? northWest(b)
+               : Step == 9  ? southEast(b)
+                            : southWest(b);
+    }
+
+    /// @brief Number of squares in the set.
+    inline int popCount(Bitboard b)
+    {
+#if defined(_MSC_VER)
+        return (int)__popcnt64(b);
+#else
+        return __builtin_popcountll(b);
+#endif
+    }
+
+    /// @brief Index of the lowest set square. The set must not be empty.
+    inline int lsb(Bitboard b)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, b);
+        return (int)index;
+#else
+        return __builtin_ctzll(b);
+#endif
+    }
+
+    /// @brief Index of the highest set square. The set must not be empty.
+    inline int msb(Bitboard b)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, b);
+        return (int)index;
+#else
+        return 63 ^ __builtin_clzll(b);
+#endif
+    }
+
+    /// @brief Removes the lowest set square from the set and returns its index.
+    inline int popLsb(Bitboard &b)
+    {
+        int square = lsb(b);
+        b &= b - 1;
+        return square;
+    }
+
+    /// @brief True if more than one square is set.
+    constexpr bool moreThanOne(Bitboard b)
+    {
+        return (b & (b - 1)) != 0;
+    }
+}
+
+#endif
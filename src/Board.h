@@ -1,14 +1,81 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include "Piece.h"
-#include "ShapeManager.h"
+#include "Bitboard.h"
+#include "Attacks.h"
+#include "Move.h"
+#include "Zobrist.h"
+
+namespace Castling
+{
+    // One bit per castling right
+    constexpr int None           = 0;
+    constexpr int WhiteKingSide  = 1;
+    constexpr int WhiteQueenSide = 2;
+    constexpr int BlackKingSide  = 4;
+    constexpr int BlackQueenSide = 8;
+    constexpr int All            = 15;
+
+    /// @brief Rights that survive a move touching the square: moving or capturing on a
+    /// king or rook home square clears the matching rights.
+    constexpr int keptBy(int square)
+    {
+        return square == 60 ? All & ~(WhiteKingSide | WhiteQueenSide)
+             : square == 4  ? All & ~(BlackKingSide | BlackQueenSide)
+             : square == 63 ? All & ~WhiteKingSide
+             : square == 56 ? All & ~WhiteQueenSide
+             : square == 7  ? All & ~BlackKingSide
+             : square == 0  ? All & ~BlackQueenSide
+                            : All;
+    }
+}
+
+/// @struct UndoInfo
+/// @brief State that makeMove cannot recompute when taking a move back.
+struct UndoInfo
+{
+    uint64_t key;           /* Zobrist key before the move, also used to find repetitions */
+    Move move;
+    uint8_t captured;       /* Captured piece, Piece::None for quiet moves */
+    uint8_t castlingRights; /* Rights before the move */
+    int8_t epSquare;        /* En passant square before the move */
+    uint16_t halfmoveClock; /* Clock before the move */
+};
 
 class Board
 {
 public:
     int Square[64]; // Non-static array
 
+    // Bitboards kept in sync with Square. Only change the position through
+    // putPiece/removePiece/movePiece, or call syncBitboards() after writing
+    // Square directly.
+    Bitboard typeBB[7];  // Squares occupied by each piece type (both colors), indexed by Piece type
+    Bitboard colorBB[2]; // Squares occupied by each color, indexed by Piece::colorIndex
+    Bitboard occupied;   // Every occupied square
+
+    int sideToMove = Piece::White;        // Piece::White or Piece::Black
+    int castlingRights = Castling::All;   // Castling:: bits still available
+    int epSquare = -1;                    // Square a pawn can capture en passant onto, or -1
+    int halfmoveClock = 0;                // Plies since the last capture or pawn move
+    int fullmoveNumber = 1;
+
+    // Zobrist key of the position, updated by XOR in the piece primitives and in makeMove;
+    // unmakeMove restores it from the undo stack. After setting sideToMove, castlingRights or epSquare directly,
+    // call syncBitboards() or assign computeKey().
+    uint64_t key = 0;
+
+    // Undo stack, one entry per move played with makeMove. Fixed size so playing and taking
+    // back moves never allocates; game and search plies share it, see Search::Searcher.
+    static constexpr int MaxHistory = 1024;
+    UndoInfo history[MaxHistory];
+    int historySize = 0;
+
     Board()
     {
         // Initialize the board
@@ -38,9 +105,388 @@ public:
         // White pawns
         for (int i = 48; i < 56; i++)
             Square[i] = Piece::White | Piece::Pawn;
+
+        syncBitboards();
+    }
+
+    // Copies only the used part of the undo stack, so boards stay cheap to copy
+    Board(const Board &other)
+    {
+        *this = other;
+    }
+
+    Board &operator=(const Board &other)
+    {
+        if (this == &other)
+            return *this;
+        std::memcpy(Square, other.Square, sizeof(Square));
+        std::memcpy(typeBB, other.typeBB, sizeof(typeBB));
+        std::memcpy(colorBB, other.colorBB, sizeof(colorBB));
+        occupied = other.occupied;
+        sideToMove = other.sideToMove;
+        castlingRights = other.castlingRights;
+        epSquare = other.epSquare;
+        halfmoveClock = other.halfmoveClock;
+        fullmoveNumber = other.fullmoveNumber;
+        key = other.key;
+        historySize = other.historySize;
+        std::copy(other.history, other.history + other.historySize, history);
+        return *this;
     }
 
     ~Board() {}
+
+    /// @brief Empties the mailbox, all bitboards and the undo stack.
+    void clear()
+    {
+        for (int i = 0; i < 64; i++)
+            Square[i] = Piece::None;
+        for (int i = 0; i < 7; i++)
+            typeBB[i] = BB::Empty;
+        colorBB[0] = colorBB[1] = BB::Empty;
+        occupied = BB::Empty;
+        key = computeKey();
+        historySize = 0;
+    }
+
+    /// @brief Rebuilds every bitboard and the key from the Square mailbox and state fields.
+    void syncBitboards()
+    {
+        for (int i = 0; i < 7; i++)
+            typeBB[i] = BB::Empty;
+        colorBB[0] = colorBB[1] = BB::Empty;
+        occupied = BB::Empty;
+
+        for (int square = 0; square < 64; square++)
+        {
+            int piece = Square[square];
+            if (Piece::type(piece) == Piece::None)
+                continue;
+            Bitboard b = BB::squareBB(square);
+            typeBB[Piece::type(piece)] |= b;
+            colorBB[Piece::colorIndex(Piece::color(piece))] |= b;
+            occupied |= b;
+        }
+        key = computeKey();
+    }
+
+    /// @brief Places a piece on an empty square.
+    ///
+    /// @param square: Index of the square (0 = a8, 63 = h1).
+    /// @param piece: Piece type OR'ed with its color.
+    void putPiece(int square, int piece)
+    {
+        Bitboard b = BB::squareBB(square);
+        Square[square] = piece;
+        typeBB[Piece::type(piece)] |= b;
+        colorBB[Piece::colorIndex(Piece::color(piece))] |= b;
+        occupied |= b;
+        key ^= Zobrist::pieceKey(piece, square);
+    }
+
+    /// @brief Removes the piece standing on a square.
+    ///
+    /// @param square: Index of an occupied square.
+    void removePiece(int square)
+    {
+        int piece = Square[square];
+        Bitboard b = BB::squareBB(square);
+        typeBB[Piece::type(piece)] ^= b;
+        colorBB[Piece::colorIndex(Piece::color(piece))] ^= b;
+        occupied ^= b;
+        Square[square] = Piece::None;
+        key ^= Zobrist::pieceKey(piece, square);
+    }
+
+    /// @brief Moves a piece to an empty square.
+    ///
+    /// @param from: Index of an occupied square.
+    /// @param to: Index of an empty square.
+    void movePiece(int from, int to)
+    {
+        int piece = Square[from];
+        Bitboard fromTo = BB::squareBB(from) | BB::squareBB(to);
+        typeBB[Piece::type(piece)] ^= fromTo;
+        colorBB[Piece::colorIndex(Piece::color(piece))] ^= fromTo;
+        occupied ^= fromTo;
+        Square[from] = Piece::None;
+        Square[to] = piece;
+        key ^= Zobrist::pieceKey(piece, from) ^ Zobrist::pieceKey(piece, to);
+    }
+
+    /// @brief Plays a legal move for the side to move, updating pieces, castling rights,
+    /// en passant square, clocks and side to move, and pushes what is needed to take it
+    /// back onto the undo stack.
+    ///
+    /// @param move: Move generated by MoveGen for this position.
+    void makeMove(const Move &move)
+    {
+        const int us = sideToMove;
+
+        assert(historySize < MaxHistory);
+        UndoInfo &undo = history[historySize++];
+        undo.key = key;
+        undo.move = move;
+        undo.captured = Piece::None;
+        undo.castlingRights = (uint8_t)castlingRights;
+        undo.epSquare = (int8_t)epSquare;
+        undo.halfmoveClock = (uint16_t)halfmoveClock;
+
+        halfmoveClock++;
+        if (Piece::type(Square[move.from()]) == Piece::Pawn || move.isCapture())
+            halfmoveClock = 0;
+
+        if (move.isCapture())
+        {
+            int capturedSquare = captureSquare(move);
+            undo.captured = (uint8_t)Square[capturedSquare];
+            removePiece(capturedSquare);
+        }
+
+        movePiece(move.from(), move.to());
+
+        if (move.isPromotion())
+        {
+            removePiece(move.to());
+            putPiece(move.to(), us | move.promotion());
+        }
+        else if (move.isCastling())
+        {
+            // Rook jumps over the king: h-file rook to the f-file, a-file rook to the d-file
+            if (move.to() > move.from())
+                movePiece(move.from() + 3, move.from() + 1);
+            else
+                movePiece(move.from() - 4, move.from() - 1);
+        }
+
+        if (epSquare >= 0)
+            key ^= Zobrist::keys.epFile[BB::fileOf(epSquare)];
+        epSquare = move.isDoublePush() ? (move.from() + move.to()) / 2 : -1;
+        if (epSquare >= 0)
+            key ^= Zobrist::keys.epFile[BB::fileOf(epSquare)];
+
+        key ^= Zobrist::keys.castling[castlingRights];
+        castlingRights &= Castling::keptBy(move.from()) & Castling::keptBy(move.to());
+        key ^= Zobrist::keys.castling[castlingRights];
+
+        if (us == Piece::Black)
+            fullmoveNumber++;
+        sideToMove = us ^ Piece::ColorMask;
+        key ^= Zobrist::keys.blackToMove;
+    }
+
+    /// @brief Takes back the last move played with makeMove.
+    void unmakeMove()
+    {
+        const UndoInfo &undo = history[--historySize];
+        const Move &move = undo.move;
+
+        sideToMove ^= Piece::ColorMask;
+        const int us = sideToMove;
+        if (us == Piece::Black)
+            fullmoveNumber--;
+
+        if (move.isPromotion())
+        {
+            removePiece(move.to());
+            putPiece(move.to(), us | Piece::Pawn);
+        }
+        else if (move.isCastling())
+        {
+            if (move.to() > move.from())
+                movePiece(move.from() + 1, move.from() + 3);
+            else
+                movePiece(move.from() - 1, move.from() - 4);
+        }
+
+        movePiece(move.to(), move.from());
+
+        if (undo.captured != Piece::None)
+            putPiece(captureSquare(move), undo.captured);
+
+        key = undo.key;
+        castlingRights = undo.castlingRights;
+        epSquare = undo.epSquare;
+        halfmoveClock = undo.halfmoveClock;
+    }
+
+    /// @brief Passes the turn without moving, for null-move pruning. The en passant square
+    /// is cleared, and so is the halfmove clock: no repetition can span a null move.
+    void makeNullMove()
+    {
+        assert(historySize < MaxHistory);
+        UndoInfo &undo = history[historySize++];
+        undo.key = key;
+        undo.move = NullMove;
+        undo.captured = Piece::None;
+        undo.castlingRights = (uint8_t)castlingRights;
+        undo.epSquare = (int8_t)epSquare;
+        undo.halfmoveClock = (uint16_t)halfmoveClock;
+
+        halfmoveClock = 0;
+        if (epSquare >= 0)
+            key ^= Zobrist::keys.epFile[BB::fileOf(epSquare)];
+        epSquare = -1;
+
+        if (sideToMove == Piece::Black)
+            fullmoveNumber++;
+        sideToMove ^= Piece::ColorMask;
+        key ^= Zobrist::keys.blackToMove;
+    }
+
+    /// @brief Takes back a move played with makeNullMove.
+    void unmakeNullMove()
+    {
+        const UndoInfo &undo = history[--historySize];
+        sideToMove ^= Piece::ColorMask;
+        if (sideToMove == Piece::Black)
+            fullmoveNumber--;
+        key = undo.key;
+        epSquare = undo.epSquare;
+        halfmoveClock = undo.halfmoveClock;
+    }
+
+    /// @brief Square of the piece a capture removes; differs from the destination for en passant.
+    /// The side to move must be the side making the move.
+    int captureSquare(const Move &move) const
+    {
+        if (move.isEnPassant())
+            return move.to() + (sideToMove == Piece::White ? 8 : -8);
+        return move.to();
+    }
+
+    /// @brief Computes the Zobrist key of the position from scratch: pieces, side to move,
+    /// castling rights and the en passant file.
+    uint64_t computeKey() const
+    {
+        uint64_t key = Zobrist::keys.castling[castlingRights];
+        for (Bitboard b = occupied; b;)
+        {
+            int square = BB::popLsb(b);
+            key ^= Zobrist::pieceKey(Square[square], square);
+        }
+        if (epSquare >= 0)
+            key ^= Zobrist::keys.epFile[BB::fileOf(epSquare)];
+        if (sideToMove == Piece::Black)
+            key ^= Zobrist::keys.blackToMove;
+        return key;
+    }
+
+    /// @brief Squares occupied by the given color (Piece::White or Piece::Black).
+    Bitboard pieces(int color) const
+    {
+        return colorBB[Piece::colorIndex(color)];
+    }
+
+    /// @brief Squares occupied by pieces of the given color and type.
+    Bitboard pieces(int color, int type) const
+    {
+        return colorBB[Piece::colorIndex(color)] & typeBB[type];
+    }
+
+    /// @brief Squares occupied by pieces of the given color and either of two types.
+    Bitboard pieces(int color, int type1, int type2) const
+    {
+        return colorBB[Piece::colorIndex(color)] & (typeBB[type1] | typeBB[type2]);
+    }
+
+    /// @brief Whether the given color has a piece other than pawns and the king. Without
+    /// one, zugzwang is common enough that passing the turn proves nothing.
+    bool hasNonPawnMaterial(int color) const
+    {
+        return (pieces(color, Piece::Knight, Piece::Bishop) | pieces(color, Piece::Rook, Piece::Queen)) != 0;
+    }
+
+    /// @brief Square of the king of the given color.
+    int kingSquare(int color) const
+    {
+        return BB::lsb(pieces(color, Piece::King));
+    }
+
+    /// @brief Pieces of both colors attacking a square, given an occupancy for the sliders.
+    Bitboard attackersTo(int square, Bitboard occupancy) const
+    {
+        return (Attacks::pawnAttacks(Piece::Black, square) & pieces(Piece::White, Piece::Pawn)) |
+               (Attacks::pawnAttacks(Piece::White, square) & pieces(Piece::Black, Piece::Pawn)) |
+               (Attacks::KnightAttacks[square] & typeBB[Piece::Knight]) |
+               (Attacks::KingAttacks[square] & typeBB[Piece::King]) |
+               (Attacks::rookAttacks(square, occupancy) & (typeBB[Piece::Rook] | typeBB[Piece::Queen])) |
+               (Attacks::bishopAttacks(square, occupancy) & (typeBB[Piece::Bishop] | typeBB[Piece::Queen]));
+    }
+
+    /// @brief Pieces of the given color that are the only piece between their own king and an
+    /// enemy slider, and therefore may only move along that line.
+    Bitboard pinnedPieces(int color) const
+    {
+        const int king = kingSquare(color);
+        const int them = color ^ Piece::ColorMask;
+
+        // Enemy sliders that would hit the king on an empty board
+        Bitboard snipers = (Attacks::rookAttacks(king, BB::Empty) & pieces(them, Piece::Rook, Piece::Queen)) |
+                           (Attacks::bishopAttacks(king, BB::Empty) & pieces(them, Piece::Bishop, Piece::Queen));
+
+        Bitboard pinned = BB::Empty;
+        while (snipers)
+        {
+            Bitboard blockers = Attacks::Between[king][BB::popLsb(snipers)] & occupied;
+            if (blockers && !BB::moreThanOne(blockers))
+                pinned |= blockers;
+        }
+        return pinned & pieces(color);
+    }
+
+    /// @brief True if any piece of the given color attacks the square.
+    bool isAttacked(int square, int byColor) const
+    {
+        return attackersTo(square, occupied) & pieces(byColor);
+    }
+
+    /// @brief Color-templated isAttacked for the move generator: only the attacker's pieces
+    /// are looked at, cheapest tests first, with the given occupancy.
+    template <int By>
+    bool attackedBy(int square, Bitboard occupancy) const
+    {
+        constexpr int Defender = By ^ Piece::ColorMask;
+        return (Attacks::pawnAttacks<Defender>(square) & pieces(By, Piece::Pawn)) ||
+               (Attacks::KnightAttacks[square] & pieces(By, Piece::Knight)) ||
+               (Attacks::KingAttacks[square] & pieces(By, Piece::King)) ||
+               (Attacks::bishopAttacks(square, occupancy) & pieces(By, Piece::Bishop, Piece::Queen)) ||
+               (Attacks::rookAttacks(square, occupancy) & pieces(By, Piece::Rook, Piece::Queen));
+    }
+
+    /// @brief True if the side to move is in check.
+    bool inCheck() const
+    {
+        return isAttacked(kingSquare(sideToMove), sideToMove ^ Piece::ColorMask);
+    }
+
+    /// @brief True if the position occurred before with the same side to move, looking back
+    /// only as far as the last capture or pawn move since nothing earlier can repeat.
+    bool isRepetition() const
+    {
+        const int oldest = std::max(0, historySize - halfmoveClock);
+        for (int i = historySize - 4; i >= oldest; i -= 2)
+        {
+            if (history[i].key == key)
+                return true;
+        }
+        return false;
+    }
+
+    /// @brief True if neither side can possibly mate: bare kings, or a single minor piece.
+    bool isInsufficientMaterial() const
+    {
+        if (typeBB[Piece::Pawn] | typeBB[Piece::Rook] | typeBB[Piece::Queen])
+            return false;
+        return !BB::moreThanOne(typeBB[Piece::Knight] | typeBB[Piece::Bishop]);
+    }
+
+    /// @brief Draw by the fifty-move rule, repetition or insufficient material. The search
+    /// scores a single repetition as a draw already.
+    bool isDraw() const
+    {
+        return halfmoveClock >= 100 || isRepetition() || isInsufficientMaterial();
+    }
 };
 
-#endif
\ No newline at end of file
+#endif
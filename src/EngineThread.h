@@ -0,0 +1,238 @@
+#ifndef ENGINETHREAD_H
+#define ENGINETHREAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "Board.h"
+#include "Move.h"
+#include "Search.h"
+#include "SpscQueue.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+/// @struct EngineEvent
+/// @brief Progress or outcome of a background search, passed to the UI thread by value.
+struct EngineEvent
+{
+    static constexpr int MaxPvLength = 16;
+
+    enum Type : uint8_t
+    {
+        Info,    /* An iteration completed */
+        BestMove /* The search ended; bestMove is the move to play */
+    };
+
+    Type type;
+    bool pondering;    /* A ponder search without ponder hit: never play its move */
+    uint32_t searchId; /* Id returned by the command that started the search */
+    int depth;
+    int score;
+    uint64_t nodes;
+    double seconds;
+    Move bestMove;
+    Move ponderMove;   /* Expected reply to bestMove, or NullMove */
+    int pvLength;
+    Move pv[MaxPvLength];
+};
+
+/// @class EngineThread
+/// @brief Runs searches on a background thread so the thread that owns the window never
+/// waits for the engine. Commands (go, ponder, stop) return immediately; progress comes
+/// back as EngineEvents through a lock-free queue the UI drains with poll() every frame.
+///
+/// Every command that starts a search returns an id that its events carry, so the UI can
+/// tell the events of a search it has since cancelled apart from the current one.
+///
+/// Pondering: after playing a move, the UI can start ponder() on the position after the
+/// expected reply. If the opponent plays it, ponderHit() turns the running search into the
+/// real one, keeping everything it has searched; otherwise stop() ends it and its events,
+/// still flagged pondering, are ignored.
+class EngineThread
+{
+public:
+    /// @param table: Transposition table of the search threads.
+    /// @param threadCount: Number of search threads (see Search::ThreadPool).
+    EngineThread(TranspositionTable &table, int threadCount)
+        : threads(table, threadCount), worker(&EngineThread::loop, this) {}
+
+    EngineThread(const EngineThread &) = delete;
+    EngineThread &operator=(const EngineThread &) = delete;
+
+    ~EngineThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quitRequested.store(true, std::memory_order_relaxed);
+            hasCommand = false;
+        }
+        stop();
+        wake.notify_one();
+        worker.join();
+    }
+
+    /// @brief Starts searching a position for a move to play, stopping any running search.
+    ///
+    /// @return Id of the new search.
+    uint32_t go(const Board &board, const Search::Limits &limits)
+    {
+        return post(board, limits, false);
+    }
+
+    /// @brief Starts thinking on the opponent's time: searches the position after the
+    /// expected reply without limits until ponderHit() or stop().
+    ///
+    /// @param limits: Limits that apply from the ponder hit on.
+    /// @return Id of the new search.
+    uint32_t ponder(const Board &board, const Search::Limits &limits)
+    {
+        Search::Limits ponderLimits = limits;
+        ponderLimits.ponder = true;
+        return post(board, ponderLimits, true);
+    }
+
+    /// @brief The expected reply was played: the ponder search goes on as the search for
+    /// the engine's move, the time already spent included (see Searcher::ponderHit).
+    void ponderHit()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hasCommand && pendingPonder)
+        {
+            // Not started yet, it simply starts as a normal search
+            pendingLimits.ponder = false;
+            pendingPonder = false;
+            return;
+        }
+        ponderHitRequested.store(true, std::memory_order_relaxed);
+        threads.ponderHit();
+    }
+
+    /// @brief Ends the running search, which still reports its BestMove event, and cancels
+    /// a search that has been requested but not started yet.
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        hasCommand = false;
+        stopRequested.store(true, std::memory_order_relaxed);
+        threads.stop();
+    }
+
+    /// @brief Takes the oldest event off the queue. UI thread only; never blocks.
+    ///
+    /// @return False if there is no event.
+    bool poll(EngineEvent &event)
+    {
+        return events.pop(event);
+    }
+
+    /// @brief Whether a search is running or about to start.
+    bool isSearching() const
+    {
+        return searching.load(std::memory_order_relaxed);
+    }
+
+    int threadCount() const
+    {
+        return threads.threadCount();
+    }
+
+private:
+    Search::ThreadPool threads;
+    std::mutex mutex; // Guards the pending command
+    std::condition_variable wake;
+    bool hasCommand = false;
+    Board pendingBoard;
+    Search::Limits pendingLimits;
+    bool pendingPonder = false;
+    uint32_t pendingId = 0;
+    uint32_t lastId = 0;
+
+    std::atomic<bool> quitRequested{false};
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> ponderHitRequested{false};
+    std::atomic<bool> searching{false};
+    SpscQueue<EngineEvent, 256> events;
+    std::thread worker; // Declared last: it starts running loop() during construction
+
+    uint32_t post(const Board &board, const Search::Limits &limits, bool pondering)
+    {
+        stop();
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingBoard = board;
+        pendingLimits = limits;
+        pendingPonder = pondering;
+        pendingId = ++lastId;
+        hasCommand = true;
+        searching.store(true, std::memory_order_relaxed);
+        wake.notify_one();
+        return pendingId;
+    }
+
+    EngineEvent makeEvent(EngineEvent::Type type, const Search::Result &result, uint32_t id, bool pondering) const
+    {
+        EngineEvent event;
+        event.type = type;
+        event.pondering = pondering && threads.isPondering();
+        event.searchId = id;
+        event.depth = result.depth;
+        event.score = result.score;
+        event.nodes = result.nodes;
+        event.seconds = result.seconds;
+        event.bestMove = result.bestMove;
+        event.ponderMove = result.pv.size() > 1 ? result.pv[1] : NullMove;
+        event.pvLength = 0;
+        for (const Move &move : result.pv)
+        {
+            if (event.pvLength == EngineEvent::MaxPvLength)
+                break;
+            event.pv[event.pvLength++] = move;
+        }
+        return event;
+    }
+
+    void loop()
+    {
+        Board board;
+        while (true)
+        {
+            Search::Limits limits;
+            bool pondering;
+            uint32_t id;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (!hasCommand)
+                    searching.store(false, std::memory_order_relaxed);
+                wake.wait(lock, [this]() { return hasCommand || quitRequested.load(std::memory_order_relaxed); });
+                if (quitRequested.load(std::memory_order_relaxed))
+                    return;
+                board = pendingBoard;
+                limits = pendingLimits;
+                pondering = pendingPonder;
+                id = pendingId;
+                hasCommand = false;
+                stopRequested.store(false, std::memory_order_relaxed);
+                ponderHitRequested.store(false, std::memory_order_relaxed);
+            }
+
+            // The pool resets its flags when it starts, so a stop() or ponderHit() that lands
+            // before that is repeated after the first iteration
+            Search::Result result = threads.search(board, limits, [&](const Search::Result &iteration)
+            {
+                if (stopRequested.load(std::memory_order_relaxed))
+                    threads.stop();
+                if (ponderHitRequested.load(std::memory_order_relaxed))
+                    threads.ponderHit();
+                // A full queue means the UI is behind; it only misses intermediate progress
+                events.push(makeEvent(EngineEvent::Info, iteration, id, pondering));
+            });
+
+            EngineEvent done = makeEvent(EngineEvent::BestMove, result, id, pondering);
+            while (!events.push(done) && !quitRequested.load(std::memory_order_relaxed))
+                std::this_thread::yield();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef EPDREADER_H
+#define EPDREADER_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// @class MappedFile
+/// @brief Read-only memory mapping of a whole file. The contents are paged in by the OS as
+/// they are touched, so even multi-gigabyte files open instantly and are never copied.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    /// @brief Maps a file, replacing any file mapped before.
+    ///
+    /// @param path: File to map.
+    /// @return False, after printing the reason, if the file cannot be mapped.
+    bool open(const char *path)
+    {
+        close();
+#if defined(_WIN32)
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            std::cerr << "Cannot open " << path << " (error " << GetLastError() << ")" << std::endl;
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        size = (size_t)fileSize.QuadPart;
+        if (size == 0)
+            return true;
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view)
+        {
+            std::cerr << "Cannot map " << path << " (error " << GetLastError() << ")" << std::endl;
+            close();
+            return false;
+        }
+        bytes = static_cast<const char *>(view);
+#else
+        descriptor = ::open(path, O_RDONLY);
+        struct stat status;
+        if (descriptor < 0 || fstat(descriptor, &status) != 0)
+        {
+            std::cerr << "Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+        size = (size_t)status.st_size;
+        if (size == 0)
+            return true;
+
+        void *view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (view == MAP_FAILED)
+        {
+            std::cerr << "Cannot map " << path << ": " << std::strerror(errno) << std::endl;
+            close();
+            return false;
+        }
+        // Records are read front to back, let the kernel read ahead aggressively
+        madvise(view, size, MADV_SEQUENTIAL);
+        bytes = static_cast<const char *>(view);
+#endif
+        return true;
+    }
+
+    void close()
+    {
+#if defined(_WIN32)
+        if (bytes)
+            UnmapViewOfFile(bytes);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes)
+            munmap(const_cast<char *>(bytes), size);
+        if (descriptor >= 0)
+            ::close(descriptor);
+        descriptor = -1;
+#endif
+        bytes = nullptr;
+        size = 0;
+    }
+
+    /// @brief Contents of the file; empty for an empty or unmapped file.
+    std::string_view data() const
+    {
+        return std::string_view(bytes, size);
+    }
+
+private:
+    const char *bytes = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int descriptor = -1;
+#endif
+};
+
+namespace Epd
+{
+    /// @struct Range
+    /// @brief Byte range [begin, end) of a file holding whole lines.
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    /// @brief Moves a byte offset forward to the start of the line it falls in, unless it
+    /// already is one.
+    inline size_t lineStart(std::string_view data, size_t offset)
+    {
+        if (offset == 0)
+            return 0;
+        if (offset >= data.size())
+            return data.size();
+        const void *newline = std::memchr(data.data() + offset - 1, '\n', data.size() - offset + 1);
+        return newline ? (size_t)(static_cast<const char *>(newline) - data.data()) + 1 : data.size();
+    }
+
+    /// @brief Splits data into count nearly equal byte ranges and returns the one at index,
+    /// with both ends moved to line starts. Every line lands in exactly one shard, so
+    /// threads can each read their own shard without coordination.
+    inline Range shard(std::string_view data, size_t index, size_t count)
+    {
+        size_t begin = (size_t)((unsigned long long)data.size() * index / count);
+        size_t end = (size_t)((unsigned long long)data.size() * (index + 1) / count);
+        return {lineStart(data, begin), lineStart(data, end)};
+    }
+
+    /// @brief Calls callback(line, offset) for every non-empty line in range, without the
+    /// line terminator ("\n" or "\r\n"). Lines are views into data, nothing is copied.
+    ///
+    /// @return Number of lines passed to callback.
+    template <typename Callback>
+    size_t forEachLine(std::string_view data, Range range, Callback &&callback)
+    {
+        size_t lines = 0;
+        size_t pos = range.begin;
+        while (pos < range.end)
+        {
+            const void *newline = std::memchr(data.data() + pos, '\n', range.end - pos);
+            size_t end = newline ? (size_t)(static_cast<const char *>(newline) - data.data()) : range.end;
+            size_t length = end - pos;
+            if (length && data[end - 1] == '\r')
+                length--;
+            if (length)
+            {
+                callback(data.substr(pos, length), pos);
+                lines++;
+            }
+            pos = end + 1;
+        }
+        return lines;
+    }
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "Bitboard.h"
+#include "Board.h"
+#include "Piece.h"
+
+namespace Eval
+{
+    // Piece-square bonuses in centipawns from white's point of view, a8 first like
+    // Board::Square. Black pieces read the table mirrored vertically (square ^ 56).
+    constexpr int PawnTable[64] = {
+         0,  0,   0,   0,   0,   0,  0,  0,
+        50, 50,  50,  50,  50,  50, 50, 50,
+        10, 10,  20,  30,  30,  20, 10, 10,
+         5,  5,  10,  25,  25,  10,  5,  5,
+         0,  0,   0,  20,  20,   0,  0,  0,
+         5, -5, -10,   0,   0, -10, -5,  5,
+         5, 10,  10, -20, -20,  10, 10,  5,
+         0,  0,   0,   0,   0,   0,  0,  0};
+
+    constexpr int KnightTable[64] = {
+        -50, -40, -30, -30, -30, -30, -40, -50,
+        -40, -20,   0,   0,   0,   0, -20, -40,
+        -30,   0,  10,  15,  15,  10,   0, -30,
+        -30,   5,  15,  20,  20,  15,   5, -30,
+        -30,   0,  15,  20,  20,  15,   0, -30,
+        -30,   5,  10,  15,  15,  10,   5, -30,
+        -40, -20,   0,   5,   5,   0, -20, -40,
+        -50, -40, -30, -30, -30, -30, -40, -50};
+
+    constexpr int BishopTable[64] = {
+        -20, -10, -10, -10, -10, -10, -10, -20,
+        -10,   0,   0,   0,   0,   0,   0, -10,
+        -10,   0,   5,  10,  10,   5,   0, -10,
+        -10,   5,   5,  10,  10,   5,   5, -10,
+        -10,   0,  10,  10,  10,  10,   0, -10,
+        -10,  10,  10,  10,  10,  10,  10, -10,
+        -10,   5,   0,   0,   0,   0,   5, -10,
+        -20, -10, -10, -10, -10, -10, -10, -20};
+
+    constexpr int RookTable[64] = {
+         0,  0,  0,  0,  0,  0,  0,  0,
+         5, 10, 10, 10, 10, 10, 10,  5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+        -5,  0,  0,  0,  0,  0,  0, -5,
+         0,  0,  0,  5,  5,  0,  0,  0};
+
+    constexpr int QueenTable[64] = {
+        -20, -10, -10, -5, -5, -10, -10, -20,
+        -10,   0,   0,  0,  0,   0,   0, -10,
+        -10,   0,   5,  5,  5,   5,   0, -10,
+         -5,   0,   5,  5,  5,   5,   0,  -5,
+          0,   0,   5,  5,  5,   5,   0,  -5,
+        -10,   5,   5,  5,  5,   5,   0, -10,
+        -10,   0,   5,  0,  0,   0,   0, -10,
+        -20, -10, -10, -5, -5, -10, -10, -20};
+
+    // The king hides behind its pawns while queens and rooks are around, and walks to the
+    // centre in the endgame
+    constexpr int KingMiddlegameTable[64] = {
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -30, -40, -40, -50, -50, -40, -40, -30,
+        -20, -30, -30, -40, -40, -30, -30, -20,
+        -10, -20, -20, -20, -20, -20, -20, -10,
+         20,  20,   0,   0,   0,   0,  20,  20,
+         20,  30,  10,   0,   0,  10,  30,  20};
+
+    constexpr int KingEndgameTable[64] = {
+        -50, -40, -30, -20, -20, -30, -40, -50,
+        -30, -20, -10,   0,   0, -10, -20, -30,
+        -30, -10,  20,  30,  30,  20, -10, -30,
+        -30, -10,  30,  40,  40,  30, -10, -30,
+        -30, -10,  30,  40,  40,  30, -10, -30,
+        -30, -10,  20,  30,  30,  20, -10, -30,
+        -30, -30,   0,   0,   0,   0, -30, -30,
+        -50, -30, -30, -30, -30, -30, -30, -50};
+
+    // Indexed by piece type; the king is handled separately
+    constexpr const int *PieceTables[7] = {nullptr, nullptr, QueenTable, BishopTable, RookTable, PawnTable, KnightTable};
+
+    // Game phase weights of the non-pawn pieces; 24 is the full starting material
+    constexpr int MaxPhase = 24;
+
+    /// @brief Material and piece-square score of one side, in centipawns.
+    ///
+    /// @param phase: Remaining material, from MaxPhase (opening) down to 0 (pawn endgame).
+    inline int evaluateSide(const Board &board, int color, int phase)
+    {
+        // Black reads the tables upside down
+        const int flip = color == Piece::White ? 0 : 56;
+        int score = 0;
+        for (int type = Piece::Queen; type <= (int)Piece::Knight; type++)
+        {
+            for (Bitboard pieces = board.pieces(color, type); pieces;)
+            {
+                int square = BB::popLsb(pieces) ^ flip;
+                score += Piece::value(type) + PieceTables[type][square];
+            }
+        }
+
+        int king = board.kingSquare(color) ^ flip;
+        score += (KingMiddlegameTable[king] * phase + KingEndgameTable[king] * (MaxPhase - phase)) / MaxPhase;
+        return score;
+    }
+
+    /// @brief Static evaluation in centipawns from the side to move's point of view.
+    inline int evaluate(const Board &board)
+    {
+        int phase = BB::popCount(board.typeBB[Piece::Knight] | board.typeBB[Piece::Bishop]) +
+                    2 * BB::popCount(board.typeBB[Piece::Rook]) + 4 * BB::popCount(board.typeBB[Piece::Queen]);
+        if (phase > MaxPhase)
+            phase = MaxPhase;
+
+        int score = evaluateSide(board, Piece::White, phase) - evaluateSide(board, Piece::Black, phase);
+        return board.sideToMove == Piece::White ? score : -score;
+    }
+}
+
+#endif
@@ -0,0 +1,469 @@
+#ifndef FEN_H
+#define FEN_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "Board.h"
+#include "Piece.h"
+
+// Standard starting position
+#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+namespace Fen
+{
+    enum Error
+    {
+        Ok,
+        MissingField,       /* Fewer than the four position fields */
+        BadPiece,           /* Character that is neither a piece, a digit nor '/' */
+        BadRankLength,      /* Rank that does not add up to 8 squares */
+        BadRankCount,       /* Placement without exactly 8 ranks */
+        BadKingCount,       /* Side without exactly one king */
+        BadPawnRank,        /* Pawn on the first or last rank */
+        BadSideToMove,      /* Side to move other than 'w' or 'b' */
+        OpponentInCheck,    /* The side not to move is in check, so its king could be captured */
+        BadCastling,        /* Castling field other than '-' or letters from "KQkq" */
+        BadEnPassant,       /* En passant square not '-' or not behind a pawn that just pushed two squares */
+        BadHalfmoveClock,   /* Halfmove clock that is not a number below 65536 */
+        BadFullmoveNumber,  /* Fullmove number that is not a number below 65536 */
+        TrailingText        /* Anything after the move clocks of a FEN */
+    };
+
+    /// @struct Result
+    /// @brief Outcome of a parse. Converts to true on success.
+    struct Result
+    {
+        Error error = Ok;
+        size_t offset = 0; /* Byte offset of the offending character or field */
+
+        explicit operator bool() const { return error == Ok; }
+    };
+
+    /// @brief Short description of an error, for messages.
+    inline const char *errorMessage(Error error)
+    {
+        switch (error)
+        {
+        case Ok:
+            return "ok";
+        case MissingField:
+            return "missing field";
+        case BadPiece:
+            return "invalid piece character";
+        case BadRankLength:
+            return "rank does not have 8 squares";
+        case BadRankCount:
+            return "placement does not have 8 ranks";
+        case BadKingCount:
+            return "each side needs exactly one king";
+        case BadPawnRank:
+            return "pawn on the first or last rank";
+        case BadSideToMove:
+            return "invalid side to move";
+        case OpponentInCheck:
+            return "side not to move is in check";
+        case BadCastling:
+            return "invalid castling rights";
+        case BadEnPassant:
+            return "invalid en passant square";
+        case BadHalfmoveClock:
+            return "invalid halfmove clock";
+        case BadFullmoveNumber:
+            return "invalid fullmove number";
+        case TrailingText:
+            return "unexpected text after the move clocks";
+        }
+        return "unknown error";
+    }
+
+    // Longest FEN write() can produce, terminator included
+    constexpr size_t MaxLength = 96;
+
+    // Character lookups generated at compile time, replacing per-character map lookups
+    constexpr std::array<uint8_t, 256> makePieceTable()
+    {
+        std::array<uint8_t, 256> table{};
+        const char letters[] = "kqbrpn";
+        for (int i = 0; i < 6; i++)
+        {
+            table[(uint8_t)letters[i]] = (uint8_t)(Piece::Black | (Piece::King + i));
+            table[(uint8_t)(letters[i] - 'a' + 'A')] = (uint8_t)(Piece::White | (Piece::King + i));
+        }
+        return table;
+    }
+
+    constexpr std::array<char, 24> makePieceChars()
+    {
+        std::array<char, 24> chars{};
+        const char letters[] = "kqbrpn";
+        for (int i = 0; i < 6; i++)
+        {
+            chars[Piece::Black | (Piece::King + i)] = letters[i];
+            chars[Piece::White | (Piece::King + i)] = (char)(letters[i] - 'a' + 'A');
+        }
+        return chars;
+    }
+
+    inline constexpr std::array<uint8_t, 256> PieceFromChar = makePieceTable();
+    inline constexpr std::array<char, 24> CharFromPiece = makePieceChars();
+
+    static_assert(PieceFromChar['N'] == (Piece::White | Piece::Knight), "piece letters follow the Piece type order");
+    static_assert(CharFromPiece[Piece::Black | Piece::Queen] == 'q', "piece letters follow the Piece type order");
+
+    constexpr bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    /// @brief Splits off the next whitespace separated field, starting at pos.
+    ///
+    /// @param pos: Read position, moved past the field.
+    /// @param start: Receives the offset of the field.
+    inline std::string_view nextField(std::string_view text, size_t &pos, size_t &start)
+    {
+        while (pos < text.size() && isSpace(text[pos]))
+            pos++;
+        start = pos;
+        while (pos < text.size() && !isSpace(text[pos]))
+            pos++;
+        return text.substr(start, pos - start);
+    }
+
+    /// @brief Parses a move clock made of digits only and below 65536.
+    inline bool parseNumber(std::string_view field, int &value)
+    {
+        if (field.empty() || field.size() > 5)
+            return false;
+        value = 0;
+        for (char c : field)
+        {
+            if (c < '0' || c > '9')
+                return false;
+            value = value * 10 + (c - '0');
+        }
+        return value < 65536;
+    }
+
+    /// @struct Position
+    /// @brief The four position fields of a FEN or EPD record, validated but not yet loaded
+    /// into a Board.
+    struct Position
+    {
+        uint8_t squares[64]; /* Piece on each square, Piece::None if empty */
+        int sideToMove;
+        int castlingRights;
+        int epSquare;        /* -1 if none */
+    };
+
+    /// @brief Parses the four position fields shared by FEN and EPD. The slider attack
+    /// tables must be initialized (Attacks::init) for the check test.
+    ///
+    /// @param pos: Read position, left after the en passant field.
+    /// @param position: Receives the position; only complete if the result is true.
+    inline Result parsePosition(std::string_view text, size_t &pos, Position &position)
+    {
+        size_t placementStart, sideStart, castlingStart, epStart;
+        std::string_view placement = nextField(text, pos, placementStart);
+        std::string_view side = nextField(text, pos, sideStart);
+        std::string_view castling = nextField(text, pos, castlingStart);
+        std::string_view enPassant = nextField(text, pos, epStart);
+        if (enPassant.empty())
+            return {MissingField, pos};
+
+        // Piece placement
+        uint8_t *squares = position.squares;
+        std::fill(squares, squares + 64, (uint8_t)Piece::None);
+        int square = 0, rankStart = 0, ranks = 1, kings[2] = {0, 0}, kingSquares[2] = {0, 0};
+        Bitboard colorBB[2] = {BB::Empty, BB::Empty}, typeBB[7] = {};
+        for (size_t i = 0; i < placement.size(); i++)
+        {
+            char c = placement[i];
+            if (c == '/')
+            {
+                if (square - rankStart != 8)
+                    return {BadRankLength, placementStart + i};
+                rankStart = square;
+                ranks++;
+            }
+            else if (c >= '1' && c <= '8')
+            {
+                square += c - '0';
+            }
+            else if (uint8_t piece = PieceFromChar[(uint8_t)c])
+            {
+                if (square >= 64)
+                    return {BadRankCount, placementStart + i};
+                if (Piece::type(piece) == Piece::Pawn && (square < 8 || square >= 56))
+                    return {BadPawnRank, placementStart + i};
+                if (Piece::type(piece) == Piece::King)
+                {
+                    kings[Piece::colorIndex(Piece::color(piece))]++;
+                    kingSquares[Piece::colorIndex(Piece::color(piece))] = square;
+                }
+                colorBB[Piece::colorIndex(Piece::color(piece))] |= BB::squareBB(square);
+                typeBB[Piece::type(piece)] |= BB::squareBB(square);
+                squares[square++] = piece;
+            }
+            else
+            {
+                return {BadPiece, placementStart + i};
+            }
+
+            if (square - rankStart > 8)
+                return {BadRankLength, placementStart + i};
+        }
+        if (ranks != 8)
+            return {BadRankCount, placementStart};
+        if (square - rankStart != 8)
+            return {BadRankLength, placementStart + placement.size()};
+        if (kings[0] != 1 || kings[1] != 1)
+            return {BadKingCount, placementStart};
+
+        // Side to move
+        if (side != "w" && side != "b")
+            return {BadSideToMove, sideStart};
+        const int sideToMove = side[0] == 'w' ? Piece::White : Piece::Black;
+
+        // The side to move could capture the other king: no move can have led here
+        const int opponent = sideToMove ^ Piece::ColorMask;
+        const int king = kingSquares[Piece::colorIndex(opponent)];
+        const Bitboard occupied = colorBB[0] | colorBB[1];
+        const Bitboard checkers = colorBB[Piece::colorIndex(sideToMove)] &
+                                  ((Attacks::pawnAttacks(opponent, king) & typeBB[Piece::Pawn]) |
+                                   (Attacks::KnightAttacks[king] & typeBB[Piece::Knight]) |
+                                   (Attacks::KingAttacks[king] & typeBB[Piece::King]) |
+                                   (Attacks::bishopAttacks(king, occupied) & (typeBB[Piece::Bishop] | typeBB[Piece::Queen])) |
+                                   (Attacks::rookAttacks(king, occupied) & (typeBB[Piece::Rook] | typeBB[Piece::Queen])));
+        if (checkers)
+            return {OpponentInCheck, sideStart};
+
+        // Castling rights
+        int castlingRights = Castling::None;
+        if (castling != "-")
+        {
+            for (size_t i = 0; i < castling.size(); i++)
+            {
+                switch (castling[i])
+                {
+                case 'K':
+                    castlingRights |= Castling::WhiteKingSide;
+                    break;
+                case 'Q':
+                    castlingRights |= Castling::WhiteQueenSide;
+                    break;
+                case 'k':
+                    castlingRights |= Castling::BlackKingSide;
+                    break;
+                case 'q':
+                    castlingRights |= Castling::BlackQueenSide;
+                    break;
+                default:
+                    return {BadCastling, castlingStart + i};
+                }
+            }
+        }
+
+        // En passant target square, behind a pawn the opponent just pushed two squares
+        int epSquare = -1;
+        if (enPassant != "-")
+        {
+            const char epRank = sideToMove == Piece::White ? '6' : '3';
+            if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] != epRank)
+                return {BadEnPassant, epStart};
+            epSquare = BB::makeSquare(enPassant[0] - 'a', enPassant[1] - '1');
+
+            // The pushed pawn stands in front of the square, which it and its origin left empty;
+            // a phantom square would let makeMove capture on an empty square
+            const int forward = sideToMove == Piece::White ? 8 : -8;
+            const int pusher = (sideToMove ^ Piece::ColorMask) | Piece::Pawn;
+            if (squares[epSquare + forward] != pusher || squares[epSquare] || squares[epSquare - forward])
+                return {BadEnPassant, epStart};
+        }
+
+        position.sideToMove = sideToMove;
+        position.castlingRights = castlingRights;
+        position.epSquare = epSquare;
+        return {};
+    }
+
+    /// @brief Replaces the contents of board with a parsed position and move clocks.
+    inline void load(const Position &position, int halfmoveClock, int fullmoveNumber, Board &board)
+    {
+        // State first so clear() starts the key from it, pieces then XOR themselves in
+        board.sideToMove = position.sideToMove;
+        board.castlingRights = position.castlingRights;
+        board.epSquare = position.epSquare;
+        board.halfmoveClock = halfmoveClock;
+        board.fullmoveNumber = fullmoveNumber;
+        board.clear();
+        for (int i = 0; i < 64; i++)
+        {
+            if (position.squares[i])
+                board.putPiece(i, position.squares[i]);
+        }
+    }
+
+    /// @brief Loads a position from a FEN string. The move clocks may be left out and then
+    /// default to 0 and 1. Never allocates. The board is left unchanged if any field is
+    /// invalid.
+    ///
+    /// @param fen: FEN string, e.g. START_FEN.
+    /// @param board: Board that receives the position.
+    /// @return Error code and offset of the problem, true on success.
+    inline Result parse(std::string_view fen, Board &board)
+    {
+        size_t pos = 0, start = 0;
+        Position position;
+        Result result = parsePosition(fen, pos, position);
+        if (!result)
+            return result;
+
+        int halfmoveClock = 0, fullmoveNumber = 1;
+        std::string_view halfmove = nextField(fen, pos, start);
+        if (!halfmove.empty())
+        {
+            if (!parseNumber(halfmove, halfmoveClock))
+                return {BadHalfmoveClock, start};
+
+            std::string_view fullmove = nextField(fen, pos, start);
+            if (!fullmove.empty())
+            {
+                if (!parseNumber(fullmove, fullmoveNumber))
+                    return {BadFullmoveNumber, start};
+                if (!nextField(fen, pos, start).empty())
+                    return {TrailingText, start};
+            }
+        }
+
+        load(position, halfmoveClock, fullmoveNumber, board);
+        return {};
+    }
+
+    /// @brief Loads the position of an EPD record: the four FEN position fields followed by
+    /// operations such as "bm e4; id \"test\";". The clocks keep their defaults of 0 and 1.
+    ///
+    /// @param operations: Receives the operations part, trimmed, as a view into epd.
+    inline Result parseEpd(std::string_view epd, Board &board, std::string_view &operations)
+    {
+        size_t pos = 0;
+        Position position;
+        Result result = parsePosition(epd, pos, position);
+        if (!result)
+            return result;
+        load(position, 0, 1, board);
+
+        while (pos < epd.size() && isSpace(epd[pos]))
+            pos++;
+        size_t end = epd.size();
+        while (end > pos && isSpace(epd[end - 1]))
+            end--;
+        operations = epd.substr(pos, end - pos);
+        return {};
+    }
+
+    inline void writeNumber(char *&out, unsigned int value)
+    {
+        char digits[10];
+        int count = 0;
+        do
+        {
+            digits[count++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value);
+        while (count)
+            *out++ = digits[--count];
+    }
+
+    /// @brief Writes the FEN of a position, move clocks included, and a terminating zero.
+    ///
+    /// @param buffer: Output of at least MaxLength characters.
+    /// @return Length of the FEN without the terminator.
+    inline size_t write(const Board &board, char *buffer)
+    {
+        char *out = buffer;
+        for (int rank = 0; rank < 8; rank++)
+        {
+            int empty = 0;
+            for (int file = 0; file < 8; file++)
+            {
+                int piece = board.Square[rank * 8 + file];
+                if (piece == Piece::None)
+                {
+                    empty++;
+                    continue;
+                }
+                if (empty)
+                    *out++ = (char)('0' + empty);
+                empty = 0;
+                *out++ = CharFromPiece[piece];
+            }
+            if (empty)
+                *out++ = (char)('0' + empty);
+            if (rank < 7)
+                *out++ = '/';
+        }
+
+        *out++ = ' ';
+        *out++ = board.sideToMove == Piece::White ? 'w' : 'b';
+
+        *out++ = ' ';
+        if (board.castlingRights == Castling::None)
+            *out++ = '-';
+        if (board.castlingRights & Castling::WhiteKingSide)
+            *out++ = 'K';
+        if (board.castlingRights & Castling::WhiteQueenSide)
+            *out++ = 'Q';
+        if (board.castlingRights & Castling::BlackKingSide)
+            *out++ = 'k';
+        if (board.castlingRights & Castling::BlackQueenSide)
+            *out++ = 'q';
+
+        *out++ = ' ';
+        if (board.epSquare < 0)
+        {
+            *out++ = '-';
+        }
+        else
+        {
+            *out++ = (char)('a' + BB::fileOf(board.epSquare));
+            *out++ = (char)('1' + BB::rankOf(board.epSquare));
+        }
+
+        *out++ = ' ';
+        writeNumber(out, (unsigned int)board.halfmoveClock);
+        *out++ = ' ';
+        writeNumber(out, (unsigned int)board.fullmoveNumber);
+        *out = '\0';
+        return (size_t)(out - buffer);
+    }
+
+    /// @brief FEN of a position as a string, for display and logging.
+    inline std::string toString(const Board &board)
+    {
+        char buffer[MaxLength];
+        return std::string(buffer, write(board, buffer));
+    }
+}
+
+/// @brief Loads a position from a FEN string and reports problems on std::cerr.
+///
+/// @param fenString: FEN string, e.g. START_FEN.
+/// @param board: Board that receives the position.
+/// @return True if the FEN was valid.
+inline bool parseFenString(std::string_view fenString, Board &board)
+{
+    Fen::Result result = Fen::parse(fenString, board);
+    if (!result)
+    {
+        std::cerr << "Invalid FEN at offset " << result.offset << ": " << Fen::errorMessage(result.error)
+                  << " in \"" << fenString << "\"" << std::endl;
+    }
+    return (bool)result;
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "Move.h"
+#include "Piece.h"
+
+// Quiet move scores filled in by the search, indexed by Piece::colorIndex, origin and destination
+typedef int ButterflyHistory[2][64][64];
+// Quiet move scores indexed by History::pieceTo of the move
+typedef int16_t PieceToHistory[16 * 64];
+// PieceToHistory of the moves following each (piece, destination) of an earlier move
+typedef PieceToHistory ContinuationHistory[16 * 64];
+
+namespace History
+{
+    // Scores stay within [-MaxScore, MaxScore], see update()
+    constexpr int MaxScore = 16384;
+    // Plies with killer moves; deeper plies share none
+    constexpr int KillerPlies = 128;
+
+    /// @brief Index of a moved piece and its destination, 0 to 1023: the color and type of
+    /// the piece in 4 bits, then the square.
+    constexpr int pieceTo(int piece, int to)
+    {
+        return ((Piece::colorIndex(Piece::color(piece)) << 3) | Piece::type(piece)) * 64 + to;
+    }
+
+    /// @brief Score change for a move that caused, or failed to prevent, a cutoff at depth.
+    inline int bonus(int depth)
+    {
+        return std::min(32 * depth * depth, 1600);
+    }
+
+    /// @brief Moves a score towards +-MaxScore by bonus, less the closer it already is. Old
+    /// scores fade as new ones come in, so the tables never need clearing or rescaling.
+    template <typename T>
+    inline void update(T &entry, int bonus)
+    {
+        entry += bonus - entry * std::abs(bonus) / MaxScore;
+    }
+}
+
+/// @struct SearchHistory
+/// @brief Move ordering statistics of one search thread, for the quiet moves the static
+/// ordering cannot tell apart. Each thread keeps its own, so they are updated without
+/// synchronization and differ between threads, which also diversifies Lazy SMP.
+struct SearchHistory
+{
+    ButterflyHistory butterfly;            /* Quiet moves by side, origin and destination */
+    ContinuationHistory continuation;      /* Quiet moves by the move one or two plies earlier */
+    Move killers[History::KillerPlies][2]; /* Quiet moves that last caused a cutoff at each ply */
+    Move counterMoves[16 * 64];            /* Quiet refutation of each pieceTo of the previous move */
+
+    void clear()
+    {
+        std::memset(butterfly, 0, sizeof(butterfly));
+        std::memset(continuation, 0, sizeof(continuation));
+        std::memset(killers, 0, sizeof(killers));
+        std::memset(counterMoves, 0, sizeof(counterMoves));
+    }
+
+    /// @brief Prepares the tables for the next search without throwing them away: the
+    /// butterfly scores are halved, and the killers move two plies up since the next root
+    /// is usually two plies below the previous one. Continuation scores decay on their own
+    /// through History::update, and counter moves stay valid.
+    void age()
+    {
+        for (int color = 0; color < 2; color++)
+            for (int from = 0; from < 64; from++)
+                for (int to = 0; to < 64; to++)
+                    butterfly[color][from][to] /= 2;
+
+        for (int ply = 0; ply + 2 < History::KillerPlies; ply++)
+        {
+            killers[ply][0] = killers[ply + 2][0];
+            killers[ply][1] = killers[ply + 2][1];
+        }
+        for (int ply = History::KillerPlies - 2; ply < History::KillerPlies; ply++)
+            killers[ply][0] = killers[ply][1] = NullMove;
+    }
+};
+
+#endif
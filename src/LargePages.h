@@ -0,0 +1,229 @@
+#ifndef LARGEPAGES_H
+#define LARGEPAGES_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#endif
+
+namespace LargePages
+{
+    // How an allocation is backed
+    enum Mode
+    {
+        Default,     /* Ordinary 4 KiB pages */
+        Transparent, /* Linux transparent huge pages, requested with madvise(MADV_HUGEPAGE) */
+        Explicit     /* Reserved huge pages: MAP_HUGETLB on Linux, MEM_LARGE_PAGES on Windows */
+    };
+
+    inline const char *modeName(Mode mode)
+    {
+        return mode == Explicit ? "explicit huge pages" : mode == Transparent ? "transparent huge pages" : "4 KiB pages";
+    }
+
+    constexpr size_t HugePageSize = 2 * 1024 * 1024;
+    // Smaller allocations are not worth a huge page, they only get cache line alignment
+    constexpr size_t CacheLineSize = 64;
+
+    /// @struct Allocation
+    /// @brief Memory returned by allocate(); bytes is the size actually reserved.
+    struct Allocation
+    {
+        void *memory = nullptr;
+        size_t bytes = 0;
+        Mode mode = Default;
+    };
+
+    inline size_t roundUp(size_t bytes, size_t multiple)
+    {
+        return (bytes + multiple - 1) / multiple * multiple;
+    }
+
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+    /// @brief Whether the kernel hands out transparent huge pages to regions that ask for
+    /// them, i.e. the policy in /sys/kernel/mm/transparent_hugepage/enabled is not "never".
+    inline bool transparentHugePagesEnabled()
+    {
+        FILE *file = std::fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+        if (!file)
+            return false;
+        char policy[128] = {};
+        size_t length = std::fread(policy, 1, sizeof(policy) - 1, file);
+        std::fclose(file);
+        policy[length] = '\0';
+        return std::strstr(policy, "[never]") == nullptr;
+    }
+#endif
+
+#if defined(_WIN32)
+    /// @brief Enables SeLockMemoryPrivilege for the process, which large pages require.
+    /// Succeeds only if an administrator granted the "Lock pages in memory" right to the user.
+    inline bool enableLockMemoryPrivilege()
+    {
+        HANDLE token;
+        if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+            return false;
+
+        TOKEN_PRIVILEGES privileges = {};
+        privileges.PrivilegeCount = 1;
+        privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+        bool enabled = LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege", &privileges.Privileges[0].Luid) &&
+                       AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+                       GetLastError() == ERROR_SUCCESS;
+        CloseHandle(token);
+        return enabled;
+    }
+#endif
+
+    /// @brief Allocates memory for a large table, backed by 2 MiB pages when the system
+    /// allows it so that random accesses across the table do not miss the TLB on every
+    /// probe. Tries reserved huge pages first, then transparent huge pages, and silently
+    /// falls back to ordinary pages. The memory is not initialized.
+    ///
+    /// @param bytes: Requested size.
+    /// @return The allocation, with memory == nullptr if even ordinary pages are unavailable.
+    inline Allocation allocate(size_t bytes)
+    {
+        Allocation allocation;
+        if (bytes == 0)
+            bytes = 1;
+
+#if defined(_WIN32)
+        size_t largePage = GetLargePageMinimum();
+        if (bytes >= HugePageSize && largePage && enableLockMemoryPrivilege())
+        {
+            size_t rounded = roundUp(bytes, largePage);
+            allocation.memory = VirtualAlloc(nullptr, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (allocation.memory)
+            {
+                allocation.bytes = rounded;
+                allocation.mode = Explicit;
+                return allocation;
+            }
+        }
+        allocation.memory = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        allocation.bytes = allocation.memory ? bytes : 0;
+        return allocation;
+#else
+        if (bytes >= HugePageSize)
+        {
+            size_t rounded = roundUp(bytes, HugePageSize);
+#if defined(MAP_HUGETLB)
+            // Only succeeds if huge pages were reserved, e.g. through /proc/sys/vm/nr_hugepages
+            void *memory = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (memory != MAP_FAILED)
+            {
+                allocation.memory = memory;
+                allocation.bytes = rounded;
+                allocation.mode = Explicit;
+                return allocation;
+            }
+#endif
+            // Aligned to a huge page so the kernel can back the whole range with them
+            if (posix_memalign(&allocation.memory, HugePageSize, rounded) != 0)
+                return Allocation();
+            allocation.bytes = rounded;
+#if defined(MADV_HUGEPAGE)
+            if (madvise(allocation.memory, rounded, MADV_HUGEPAGE) == 0 && transparentHugePagesEnabled())
+                allocation.mode = Transparent;
+#endif
+            return allocation;
+        }
+
+        if (posix_memalign(&allocation.memory, CacheLineSize, roundUp(bytes, CacheLineSize)) != 0)
+            return Allocation();
+        allocation.bytes = bytes;
+        return allocation;
+#endif
+    }
+
+    /// @brief Returns memory obtained from allocate() and resets the allocation.
+    inline void release(Allocation &allocation)
+    {
+        if (!allocation.memory)
+            return;
+#if defined(_WIN32)
+        VirtualFree(allocation.memory, 0, MEM_RELEASE);
+#else
+        if (allocation.mode == Explicit)
+            munmap(allocation.memory, allocation.bytes);
+        else
+            std::free(allocation.memory);
+#endif
+        allocation = Allocation();
+    }
+
+    /// @class Array
+    /// @brief Fixed-size array of default-constructed elements in memory from allocate(),
+    /// for tables too large to leave to operator new.
+    template <typename T>
+    class Array
+    {
+    public:
+        Array() = default;
+        Array(const Array &) = delete;
+        Array &operator=(const Array &) = delete;
+
+        ~Array()
+        {
+            reset();
+        }
+
+        /// @brief Replaces the contents with count default-constructed elements.
+        ///
+        /// @return False if the memory cannot be allocated; the array is then empty.
+        bool allocate(size_t count)
+        {
+            static_assert(alignof(T) <= CacheLineSize, "Alignment beyond a cache line is not supported");
+            reset();
+            allocation = LargePages::allocate(count * sizeof(T));
+            if (!allocation.memory)
+                return false;
+            elements = static_cast<T *>(allocation.memory);
+            for (size_t i = 0; i < count; i++)
+                new (&elements[i]) T();
+            elementCount = count;
+            return true;
+        }
+
+        void reset()
+        {
+            for (size_t i = 0; i < elementCount; i++)
+                elements[i].~T();
+            release(allocation);
+            elements = nullptr;
+            elementCount = 0;
+        }
+
+        T &operator[](size_t index) { return elements[index]; }
+        const T &operator[](size_t index) const { return elements[index]; }
+
+        size_t size() const
+        {
+            return elementCount;
+        }
+
+        /// @brief How the memory is backed; reported at startup by the tools.
+        Mode mode() const
+        {
+            return allocation.mode;
+        }
+
+    private:
+        Allocation allocation;
+        T *elements = nullptr;
+        size_t elementCount = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef MAGIC_H
+#define MAGIC_H
+
+#include <cstddef>
+#include "Bitboard.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#define MAGIC_X86 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define MAGIC_X86 1
+#endif
+
+namespace Magic
+{
+    // How the slider tables are indexed. Both backends share the same tables and sizes,
+    // only the order of the entries within a square's slice differs.
+    enum Backend
+    {
+        Auto,     /* Pick Pext when the CPU has a fast PEXT instruction, Multiply otherwise */
+        Multiply, /* Portable magic multiplication */
+        Pext      /* BMI2 parallel bit extract */
+    };
+
+    inline Backend activeBackend = Multiply;
+
+    /// @brief Parallel bit extract: gathers the bits of value selected by mask into the low bits.
+    /// Only called when the CPU reported BMI2. Inline assembly keeps it inlinable into code
+    /// compiled without -mbmi2.
+    inline Bitboard pext(Bitboard value, Bitboard mask)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        return _pext_u64(value, mask);
+#elif defined(MAGIC_X86) && defined(__x86_64__)
+        Bitboard result;
+        __asm__("pextq %2, %1, %0" : "=r"(result) : "r"(value), "r"(mask));
+        return result;
+#else
+        // Never selected on these targets since hasBmi2() is false; kept for completeness
+        Bitboard result = 0;
+        for (Bitboard bit = 1; mask; bit <<= 1, mask &= mask - 1)
+        {
+            if (value & mask & (0 - mask))
+                result |= bit;
+        }
+        return result;
+#endif
+    }
+
+    /// @brief Executes CPUID for a leaf (subleaf 0) and stores eax, ebx, ecx, edx.
+    inline void cpuid(unsigned int leaf, unsigned int regs[4])
+    {
+        regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#if defined(MAGIC_X86) && defined(_MSC_VER)
+        __cpuidex((int *)regs, (int)leaf, 0);
+#elif defined(MAGIC_X86)
+        __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#else
+        (void)leaf;
+#endif
+    }
+
+    /// @brief True if the CPU implements BMI2 (and therefore PEXT) in 64-bit mode.
+    inline bool hasBmi2()
+    {
+#if defined(MAGIC_X86) && (defined(_M_X64) || defined(__x86_64__))
+        unsigned int regs[4];
+        cpuid(0, regs);
+        if (regs[0] < 7)
+            return false;
+        cpuid(7, regs);
+        return (regs[1] >> 8) & 1;
+#else
+        return false;
+#endif
+    }
+
+    /// @brief True if PEXT is available and fast. AMD processors before Zen 3 (family 0x19)
+    /// implement it in microcode, far slower than a multiplication, so they are excluded.
+    inline bool hasFastPext()
+    {
+        if (!hasBmi2())
+            return false;
+
+        unsigned int regs[4];
+        cpuid(0, regs);
+        // "AuthenticAMD" is spread over ebx, edx, ecx
+        bool amd = regs[1] == 0x68747541 && regs[3] == 0x69746e65 && regs[2] == 0x444d4163;
+        if (!amd)
+            return true;
+
+        cpuid(1, regs);
+        unsigned int family = ((regs[0] >> 8) & 0xF) + ((regs[0] >> 20) & 0xFF);
+        return family >= 0x19;
+    }
+
+    /// @struct Entry
+    /// @brief Per-square data used to look up slider attacks. The relevant blockers are
+    /// either multiplied by the magic number, which maps every blocker subset onto a unique
+    /// index in the top bits of the product, or packed into an index with PEXT.
+    struct Entry
+    {
+        Bitboard mask;      /* Relevant occupancy: the empty-board rays without their edge squares */
+        Bitboard magic;     /* Multiplier */
+        Bitboard *attacks;  /* First entry of this square's slice of the attack table */
+        unsigned int shift; /* 64 minus the number of relevant occupancy bits */
+
+        unsigned int index(Bitboard occupied) const
+        {
+            // The branch is constant for the whole run and predicts perfectly
+            if (activeBackend == Pext)
+                return (unsigned int)pext(occupied, mask);
+            return (unsigned int)(((occupied & mask) * magic) >> shift);
+        }
+    };
+
+    // Magic numbers for the a8 = 0 square layout, found offline by a sparse random search.
+    // They produce collision-free indices with the minimal number of bits per square.
+    constexpr Bitboard RookNumbers[64] = {
+        0x0080008620504002ULL, 0x8200204011060080ULL, 0x008010008020000cULL, 0x0100062009001000ULL,
+        0x0200020020081005ULL, 0x8100040001000802ULL, 0x4400008108041002ULL, 0x030002028040a500ULL,
+        0x1024800040002880ULL, 0x8113002040030282ULL, 0x0002802000801000ULL, 0x4001002010000901ULL,
+        0x0000808004000800ULL, 0x0240800200800400ULL, 0x0030808100020080ULL, 0x8006000408408102ULL,
+        0xd00d010024408000ULL, 0x0380404000201000ULL, 0x0040410020001100ULL, 0x0000210010010008ULL,
+        0x1000ba0020120a00ULL, 0x0022008002040080ULL, 0x0000040002900801ULL, 0x80d0020001004084ULL,
+        0x2018806080064000ULL, 0x0000400080200080ULL, 0x0001004300122000ULL, 0x4022004200102008ULL,
+        0x0040040080080080ULL, 0xd012c04801102004ULL, 0x8260020400010870ULL, 0x0202108200011044ULL,
+        0x8000400081800220ULL, 0x0000400080802000ULL, 0x0000200084801008ULL, 0x1000800800801000ULL,
+        0x8000080005001100ULL, 0x0004800400800200ULL, 0x130106030c002810ULL, 0x0000801060800100ULL,
+        0x00c0004020908000ULL, 0x2000200050084004ULL, 0x0010002000108080ULL, 0x0801001004090020ULL,
+        0x0208000900110004ULL, 0x0400040002008080ULL, 0x1000021001040008ULL, 0x140500208045000aULL,
+        0x0080010080402500ULL, 0x2030904000200880ULL, 0x9880802000100080ULL, 0xa001000820100100ULL,
+        0x142800e400800880ULL, 0x220c800400020080ULL, 0x5000010208100400ULL, 0x0000008401004200ULL,
+        0x8080024010842301ULL, 0x0820b200228104c2ULL, 0x088080881240a202ULL, 0x0048082100041001ULL,
+        0x4001000204100801ULL, 0x020100124804000bULL, 0x08430010c4020021ULL, 0x80000d040a204a82ULL,
+    };
+
+    constexpr Bitboard BishopNumbers[64] = {
+        0x08c0380800428422ULL, 0x08a0011202005000ULL, 0xa011440402404420ULL, 0x008c2c0080010020ULL,
+        0x8201104008381007ULL, 0x0201040240414000ULL, 0x04010c1004440481ULL, 0x2001004802080240ULL,
+        0x2804408208010121ULL, 0x0000040108120081ULL, 0x000031380a004201ULL, 0x0a00044400800420ULL,
+        0x00000511400c0400ULL, 0x8002020282200004ULL, 0x0042240088041040ULL, 0x0480220090880850ULL,
+        0x0010000405080800ULL, 0x1430006002425040ULL, 0x0408041020244010ULL, 0x1004000524008400ULL,
+        0x02cc008211040080ULL, 0x4082004100410400ULL, 0x0210800048541000ULL, 0x200504a024020214ULL,
+        0x0a08040c08107080ULL, 0x0002200002040400ULL, 0x0294012042080500ULL, 0x0000808008020002ULL,
+        0x8001010008104000ULL, 0x1048460001010100ULL, 0x1202040808440200ULL, 0xa00061010a010118ULL,
+        0x0090880401200400ULL, 0x6900842000042810ULL, 0x000403a809040048ULL, 0x2090200800190811ULL,
+        0x01004900400c0040ULL, 0x1520010040120801ULL, 0x0270008100408408ULL, 0x000842004000290aULL,
+        0x00020203c0406000ULL, 0x400100b010040409ULL, 0x0012010448000100ULL, 0x0000402024285800ULL,
+        0x1440400812000040ULL, 0x0440101400412022ULL, 0x02080134040e8498ULL, 0x10c1010210820210ULL,
+        0x2182541054100042ULL, 0x0484220802081250ULL, 0x0004242205500404ULL, 0x0008400884040080ULL,
+        0xc400040883040804ULL, 0x2c00482008122830ULL, 0x0084040802140014ULL, 0x0008010840830901ULL,
+        0x1002422410080411ULL, 0x04021610840108a0ULL, 0x8020304080480808ULL, 0x80000901020a0200ULL,
+        0x0001141a40504d08ULL, 0x2040002950012a08ULL, 0x0420501042c88400ULL, 0x50400c1144010111ULL,
+    };
+
+    // Sum of 2^bits over all squares
+    constexpr size_t RookTableSize = 102400;
+    constexpr size_t BishopTableSize = 5248;
+
+    inline Entry RookEntries[64];
+    inline Entry BishopEntries[64];
+    inline Bitboard RookTable[RookTableSize];
+    inline Bitboard BishopTable[BishopTableSize];
+
+    /// @brief Computes slider attacks by walking each direction until a blocker.
+    /// Only used to fill the tables.
+    ///
+    /// @param square: Origin square.
+    /// @param occupied: Blocking pieces.
+    /// @param rook: True for orthogonal directions, false for diagonals.
+    inline Bitboard slidingAttacks(int square, Bitboard occupied, bool rook)
+    {
+        static const int directions[2][4][2] = {
+            {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}}, // Bishop (file, rank) steps
+            {{1, 0}, {-1, 0}, {0, 1}, {0, -1}}    // Rook
+        };
+
+        Bitboard attacks = BB::Empty;
+        for (const auto &direction : directions[rook])
+        {
+            int file = BB::fileOf(square) + direction[0];
+            int rank = BB::rankOf(square) + direction[1];
+            while (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+            {
+                Bitboard b = BB::squareBB(BB::makeSquare(file, rank));
+                attacks |= b;
+                if (occupied & b)
+                    break;
+                file += direction[0];
+                rank += direction[1];
+            }
+        }
+        return attacks;
+    }
+
+    /// @brief Fills the entries and the attack table of one slider type.
+    inline void initSlider(Entry entries[], Bitboard table[], const Bitboard numbers[], bool rook)
+    {
+        Bitboard *next = table;
+        for (int square = 0; square < 64; square++)
+        {
+            // Edge squares never block anything further along the ray
+            Bitboard edges = ((BB::Rank1 | BB::Rank8) & ~BB::rankBB(square)) |
+                             ((BB::FileA | BB::FileH) & ~BB::fileBB(square));
+
+            Entry &entry = entries[square];
+            entry.mask = slidingAttacks(square, BB::Empty, rook) & ~edges;
+            entry.magic = numbers[square];
+            entry.shift = 64 - BB::popCount(entry.mask);
+            entry.attacks = next;
+
+            // Enumerate every subset of the mask (Carry-Rippler trick)
+            Bitboard subset = BB::Empty;
+            do
+            {
+                entry.attacks[entry.index(subset)] = slidingAttacks(square, subset, rook);
+                subset = (subset - entry.mask) & entry.mask;
+            } while (subset);
+
+            next += 1ULL << BB::popCount(entry.mask);
+        }
+    }
+
+    /// @brief Selects the indexing backend and fills the rook and bishop tables for it.
+    /// Called by Attacks::init(); may be called again to switch backends, e.g. for benchmarks.
+    ///
+    /// @param backend: Requested backend. Pext falls back to Multiply when the CPU lacks BMI2.
+    inline void init(Backend backend = Auto)
+    {
+        if (backend == Auto)
+            activeBackend = hasFastPext() ? Pext : Multiply;
+        else
+            activeBackend = (backend == Pext && hasBmi2()) ? Pext : Multiply;
+
+        initSlider(RookEntries, RookTable, RookNumbers, true);
+        initSlider(BishopEntries, BishopTable, BishopNumbers, false);
+    }
+
+    /// @brief Name of the backend in use, for startup reports.
+    inline const char *backendName()
+    {
+        return activeBackend == Pext ? "pext" : "magic";
+    }
+
+    /// @brief Bytes used by the entries and attack tables.
+    constexpr size_t memoryUsage()
+    {
+        return sizeof(RookEntries) + sizeof(BishopEntries) + sizeof(RookTable) + sizeof(BishopTable);
+    }
+
+    inline Bitboard rookAttacks(int square, Bitboard occupied)
+    {
+        const Entry &entry = RookEntries[square];
+        return entry.attacks[entry.index(occupied)];
+    }
+
+    inline Bitboard bishopAttacks(int square, Bitboard occupied)
+    {
+        const Entry &entry = BishopEntries[square];
+        return entry.attacks[entry.index(occupied)];
+    }
+}
+
+#endif
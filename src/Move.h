@@ -0,0 +1,104 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <cstdint>
+#include <string>
+#include "Piece.h"
+#include "Bitboard.h"
+
+/// @struct Move
+/// @brief Move packed into 16 bits: origin in bits 0-5, destination in bits 6-11 and the
+/// kind of move in bits 12-15. Cheap to copy, compare and store in tables.
+///
+/// The kind uses bit 2 for captures and bit 3 for promotions; a promotion keeps the piece
+/// in the two low bits, otherwise they tell quiet, double push, castling and en passant apart.
+struct Move
+{
+    // Kinds passed to the constructor. EnPassant already includes Capture.
+    static constexpr int Quiet      = 0;
+    static constexpr int DoublePush = 1;
+    static constexpr int Castling   = 2;
+    static constexpr int Capture    = 4;
+    static constexpr int EnPassant  = 5;
+    static constexpr int Promotion  = 8;
+
+    uint16_t data; // Left uninitialized so move lists cost nothing to create; Move{} is the null move
+
+    Move() = default;
+    /// @param from: Origin square (0 = a8, 63 = h1).
+    /// @param to: Destination square.
+    /// @param kind: Quiet, DoublePush, Castling, Capture or EnPassant.
+    /// @param promotion: Piece type a pawn promotes to, or Piece::None.
+    constexpr Move(int from, int to, int kind = Quiet, int promotion = Piece::None)
+        : data((uint16_t)(from | (to << 6) | ((kind | promotionBits(promotion)) << 12))) {}
+
+    constexpr int from() const { return data & 63; }
+    constexpr int to() const { return (data >> 6) & 63; }
+    constexpr int kind() const { return data >> 12; }
+
+    /// @brief Piece type a pawn promotes to, or Piece::None.
+    constexpr int promotion() const
+    {
+        constexpr int pieces[4] = {Piece::Knight, Piece::Bishop, Piece::Rook, Piece::Queen};
+        return isPromotion() ? pieces[kind() & 3] : (int)Piece::None;
+    }
+
+    constexpr bool isCapture() const { return kind() & Capture; }
+    constexpr bool isPromotion() const { return kind() & Promotion; }
+    constexpr bool isEnPassant() const { return kind() == EnPassant; }
+    constexpr bool isCastling() const { return kind() == Castling; }
+    constexpr bool isDoublePush() const { return kind() == DoublePush; }
+
+    constexpr bool operator==(const Move &other) const { return data == other.data; }
+    constexpr bool operator!=(const Move &other) const { return data != other.data; }
+
+private:
+    static constexpr int promotionBits(int promotion)
+    {
+        return promotion == Piece::Knight   ? Promotion | 0
+               : promotion == Piece::Bishop ? Promotion | 1
+               : promotion == Piece::Rook   ? Promotion | 2
+               : promotion == Piece::Queen  ? Promotion | 3
+                                            : 0;
+    }
+};
+
+// No move goes from a8 to a8, so the all-zero move marks "no move"
+inline constexpr Move NullMove = Move(0, 0);
+
+static_assert(sizeof(Move) == 2, "Move must stay 16 bits");
+static_assert(Move(52, 36, Move::DoublePush).to() == 36, "e2e4 lands on e4");
+static_assert(Move(12, 3, Move::Capture, Piece::Queen).promotion() == Piece::Queen, "promotion survives packing");
+
+/// @brief Returns the algebraic name of a square, e.g. "e4".
+inline std::string squareName(int square)
+{
+    std::string name;
+    name += char('a' + BB::fileOf(square));
+    name += char('1' + BB::rankOf(square));
+    return name;
+}
+
+/// @brief Returns a move in coordinate notation, e.g. "e2e4" or "e7e8q".
+inline std::string moveToString(const Move &move)
+{
+    std::string text = squareName(move.from()) + squareName(move.to());
+    switch (move.promotion())
+    {
+    case Piece::Queen:
+        text += 'q';
+        break;
+    case Piece::Rook:
+        text += 'r';
+        break;
+    case Piece::Bishop:
+        text += 'b';
+        break;
+    case Piece::Knight:
+        text += 'n';
+        break;
+    }
+    return text;
+}
+
+#endif
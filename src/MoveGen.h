@@ -0,0 +1,565 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "Board.h"
+#include "Move.h"
+#include "MoveList.h"
+
+namespace MoveGen
+{
+    /// @brief Adds one move per target square, flagging captures of enemy pieces.
+    inline void addMoves(const Board &board, int from, Bitboard targets, MoveList &moves)
+    {
+        while (targets)
+        {
+            int to = BB::popLsb(targets);
+            moves.emplace_back(from, to, board.Square[to] != Piece::None ? Move::Capture : Move::Quiet);
+        }
+    }
+
+    /// @brief Adds the four promotions of a pawn move.
+    inline void addPromotions(int from, int to, int flags, MoveList &moves)
+    {
+        moves.emplace_back(from, to, flags, Piece::Queen);
+        moves.emplace_back(from, to, flags, Piece::Rook);
+        moves.emplace_back(from, to, flags, Piece::Bishop);
+        moves.emplace_back(from, to, flags, Piece::Knight);
+    }
+
+    /// @brief Adds a pawn move, or its promotions when it reaches the last rank.
+    inline void addPawnMove(int from, int to, int flags, Bitboard promotionRank, MoveList &moves)
+    {
+        if (BB::squareBB(to) & promotionRank)
+            addPromotions(from, to, flags, moves);
+        else
+            moves.emplace_back(from, to, flags);
+    }
+
+    /// @brief Generates pawn pushes and captures (without en passant) landing on target.
+    /// A pinned pawn only keeps the moves that stay on the line through its king.
+    ///
+    /// @param target: Allowed destination squares.
+    /// @param pinned: Own pinned pieces, or empty for pseudo-legal generation.
+    inline void generatePawnMoves(const Board &board, Bitboard target, Bitboard pinned, MoveList &moves)
+    {
+        const int us = board.sideToMove;
+        const int them = us ^ Piece::ColorMask;
+        const bool white = us == Piece::White;
+        const int up = white ? -8 : 8;
+        const Bitboard promotionRank = white ? BB::Rank8 : BB::Rank1;
+        const Bitboard doublePushRank = white ? BB::Rank3 : BB::Rank6;
+        const Bitboard empty = ~board.occupied;
+        const Bitboard enemies = board.pieces(them) & target;
+        const Bitboard pawns = board.pieces(us, Piece::Pawn);
+        const int king = pinned ? board.kingSquare(us) : 0;
+
+        auto allowed = [&](int from, int to)
+        {
+            return !(pinned & BB::squareBB(from)) || (Attacks::Line[king][from] & BB::squareBB(to));
+        };
+
+        // Pushes, computed for all pawns at once. A double push may pass a square outside
+        // target and still block a check on its destination.
+        Bitboard single = (white ? BB::north(pawns) : BB::south(pawns)) & empty;
+        Bitboard doubles = (white ? BB::north(single & doublePushRank) : BB::south(single & doublePushRank)) & empty & target;
+        single &= target;
+
+        while (single)
+        {
+            int to = BB::popLsb(single);
+            if (allowed(to - up, to))
+                addPawnMove(to - up, to, Move::Quiet, promotionRank, moves);
+        }
+        while (doubles)
+        {
+            int to = BB::popLsb(doubles);
+            if (allowed(to - 2 * up, to))
+                moves.emplace_back(to - 2 * up, to, Move::DoublePush);
+        }
+
+        // Captures
+        Bitboard capturers = pawns;
+        while (capturers)
+        {
+            int from = BB::popLsb(capturers);
+            Bitboard targets = Attacks::pawnAttacks(us, from) & enemies;
+            while (targets)
+            {
+                int to = BB::popLsb(targets);
+                if (allowed(from, to))
+                    addPawnMove(from, to, Move::Capture, promotionRank, moves);
+            }
+        }
+    }
+
+    /// @brief Our pawns standing where an enemy pawn on the en passant square would attack.
+    inline Bitboard enPassantCapturers(const Board &board)
+    {
+        if (board.epSquare < 0)
+            return BB::Empty;
+        const int us = board.sideToMove;
+        return Attacks::pawnAttacks(us ^ Piece::ColorMask, board.epSquare) & board.pieces(us, Piece::Pawn);
+    }
+
+    /// @brief Generates knight, bishop, rook and queen moves landing on target. A pinned
+    /// slider only keeps the moves along the line through its king; pinned knights never move.
+    ///
+    /// @param target: Allowed destination squares.
+    /// @param pinned: Own pinned pieces, or empty for pseudo-legal generation.
+    inline void generatePieceMoves(const Board &board, Bitboard target, Bitboard pinned, MoveList &moves)
+    {
+        const int us = board.sideToMove;
+        const int king = pinned ? board.kingSquare(us) : 0;
+
+        Bitboard knights = board.pieces(us, Piece::Knight) & ~pinned;
+        while (knights)
+        {
+            int from = BB::popLsb(knights);
+            addMoves(board, from, Attacks::KnightAttacks[from] & target, moves);
+        }
+
+        Bitboard diagonal = board.pieces(us, Piece::Bishop, Piece::Queen);
+        while (diagonal)
+        {
+            int from = BB::popLsb(diagonal);
+            Bitboard attacks = Attacks::bishopAttacks(from, board.occupied) & target;
+            if (pinned & BB::squareBB(from))
+                attacks &= Attacks::Line[king][from];
+            addMoves(board, from, attacks, moves);
+        }
+
+        Bitboard straight = board.pieces(us, Piece::Rook, Piece::Queen);
+        while (straight)
+        {
+            int from = BB::popLsb(straight);
+            Bitboard attacks = Attacks::rookAttacks(from, board.occupied) & target;
+            if (pinned & BB::squareBB(from))
+                attacks &= Attacks::Line[king][from];
+            addMoves(board, from, attacks, moves);
+        }
+    }
+
+    inline void generateCastling(const Board &board, MoveList &moves)
+    {
+        const int us = board.sideToMove;
+        const int them = us ^ Piece::ColorMask;
+        const bool white = us == Piece::White;
+        const int kingSideRight = white ? Castling::WhiteKingSide : Castling::BlackKingSide;
+        const int queenSideRight = white ? Castling::WhiteQueenSide : Castling::BlackQueenSide;
+
+        if (!(board.castlingRights & (kingSideRight | queenSideRight)))
+            return;
+
+        // e1 or e8; the rights imply the king is still on its original square
+        const int king = white ? 60 : 4;
+        if (board.Square[king] != int(us | Piece::King) || board.isAttacked(king, them))
+            return;
+
+        if ((board.castlingRights & kingSideRight) && board.Square[king + 3] == int(us | Piece::Rook) &&
+            !(board.occupied & (BB::squareBB(king + 1) | BB::squareBB(king + 2))) &&
+            !board.isAttacked(king + 1, them) && !board.isAttacked(king + 2, them))
+        {
+            moves.emplace_back(king, king + 2, Move::Castling);
+        }
+
+        if ((board.castlingRights & queenSideRight) && board.Square[king - 4] == int(us | Piece::Rook) &&
+            !(board.occupied & (BB::squareBB(king - 1) | BB::squareBB(king - 2) | BB::squareBB(king - 3))) &&
+            !board.isAttacked(king - 1, them) && !board.isAttacked(king - 2, them))
+        {
+            moves.emplace_back(king, king - 2, Move::Castling);
+        }
+    }
+
+    /// @brief Generates every pseudo-legal move for the side to move, i.e. moves that may
+    /// still leave the own king in check. Castling is fully checked here.
+    ///
+    /// @param board: Position to generate moves for.
+    /// @param moves: List the moves are appended to.
+    inline void generatePseudoLegal(const Board &board, MoveList &moves)
+    {
+        const int us = board.sideToMove;
+        const Bitboard target = ~board.pieces(us);
+
+        generatePawnMoves(board, target, BB::Empty, moves);
+        for (Bitboard capturers = enPassantCapturers(board); capturers;)
+            moves.emplace_back(BB::popLsb(capturers), board.epSquare, Move::EnPassant);
+
+        generatePieceMoves(board, target, BB::Empty, moves);
+
+        int king = board.kingSquare(us);
+        addMoves(board, king, Attacks::KingAttacks[king] & target, moves);
+
+        generateCastling(board, moves);
+    }
+
+    /// @brief Checks whether a pseudo-legal move leaves the own king safe, without
+    /// modifying the board: the resulting occupancy is used to look for attackers.
+    inline bool isLegal(const Board &board, const Move &move)
+    {
+        // Castling safety is verified during generation
+        if (move.isCastling())
+            return true;
+
+        const int us = board.sideToMove;
+        const int them = us ^ Piece::ColorMask;
+        Bitboard occupancy = (board.occupied ^ BB::squareBB(move.from())) | BB::squareBB(move.to());
+        Bitboard captured = move.isCapture() ? BB::squareBB(move.to()) : BB::Empty;
+
+        if (move.isEnPassant())
+        {
+            int capturedSquare = move.to() + (us == Piece::White ? 8 : -8);
+            captured = BB::squareBB(capturedSquare);
+            occupancy ^= captured;
+        }
+
+        int king = board.kingSquare(us);
+        if (move.from() == king)
+            king = move.to();
+
+        return !(board.attackersTo(king, occupancy) & board.pieces(them) & ~captured);
+    }
+
+    /// @brief Checks that a move taken from elsewhere (hash table, killer slots) can be played
+    /// in this position, except that it may leave the own king in check; see isLegal.
+    inline bool isPseudoLegal(const Board &board, const Move &move)
+    {
+        const int us = board.sideToMove;
+        const int from = move.from(), to = move.to();
+        const int piece = board.Square[from];
+        if (from == to || piece == Piece::None || Piece::color(piece) != us || (board.pieces(us) & BB::squareBB(to)))
+            return false;
+        // Kinds 3, 6 and 7 are unused
+        if (move.kind() == 3 || move.kind() == 6 || move.kind() == 7)
+            return false;
+
+        if (move.isCastling())
+        {
+            MoveList castling;
+            generateCastling(board, castling);
+            return castling.contains(move);
+        }
+
+        const int type = Piece::type(piece);
+        if (move.isEnPassant())
+            return type == Piece::Pawn && to == board.epSquare && (Attacks::pawnAttacks(us, from) & BB::squareBB(to));
+        if (move.isCapture() != (board.Square[to] != Piece::None))
+            return false;
+
+        if (type != Piece::Pawn)
+        {
+            return (move.kind() == Move::Quiet || move.kind() == Move::Capture) &&
+                   (Attacks::pieceAttacks(type, from, board.occupied) & BB::squareBB(to));
+        }
+
+        const bool white = us == Piece::White;
+        const int up = white ? -8 : 8;
+        if (move.isPromotion() != bool(BB::squareBB(to) & (white ? BB::Rank8 : BB::Rank1)))
+            return false;
+        if (move.isCapture())
+            return Attacks::pawnAttacks(us, from) & BB::squareBB(to);
+        if (move.isDoublePush())
+        {
+            return (BB::squareBB(from) & (white ? BB::Rank2 : BB::Rank7)) && to == from + 2 * up &&
+                   board.Square[from + up] == Piece::None;
+        }
+        return to == from + up;
+    }
+
+    /// @brief Generates every legal move without testing each one, branching on the side to
+    /// move at runtime. Kept as the reference for generateLegal in perft comparisons.
+    ///
+    /// Checkers and pinned pieces are computed once per position. In double check only the
+    /// king moves; in single check the other pieces may only capture the checker or block
+    /// between it and the king. Pinned pieces stay on their pin line, and king destinations
+    /// are tested with the king removed from the occupancy so it cannot step back along a
+    /// checking ray. Only en passant, which can uncover a rank attack through two pawns,
+    /// still goes through isLegal.
+    ///
+    /// @param board: Position to generate moves for.
+    /// @param moves: List the moves are appended to.
+    inline void generateLegalRuntime(const Board &board, MoveList &moves)
+    {
+        const int us = board.sideToMove;
+        const int them = us ^ Piece::ColorMask;
+        const int king = board.kingSquare(us);
+        const Bitboard ours = board.pieces(us);
+        const Bitboard enemies = board.pieces(them);
+        const Bitboard checkers = board.attackersTo(king, board.occupied) & enemies;
+
+        // King moves
+        Bitboard withoutKing = board.occupied ^ BB::squareBB(king);
+        Bitboard kingTargets = Attacks::KingAttacks[king] & ~ours;
+        while (kingTargets)
+        {
+            int to = BB::popLsb(kingTargets);
+            if (!(board.attackersTo(to, withoutKing) & enemies))
+                moves.emplace_back(king, to, board.Square[to] != Piece::None ? Move::Capture : Move::Quiet);
+        }
+
+        if (BB::moreThanOne(checkers))
+            return;
+
+        // Squares that resolve a single check, otherwise anything not holding an own piece
+        const Bitboard target = checkers ? Attacks::Between[king][BB::lsb(checkers)] | checkers : ~ours;
+        const Bitboard pinned = board.pinnedPieces(us);
+
+        generatePawnMoves(board, target, pinned, moves);
+        for (Bitboard capturers = enPassantCapturers(board); capturers;)
+        {
+            Move move(BB::popLsb(capturers), board.epSquare, Move::EnPassant);
+            if (isLegal(board, move))
+                moves.push_back(move);
+        }
+
+        generatePieceMoves(board, target, pinned, moves);
+
+        if (!checkers)
+            generateCastling(board, moves);
+    }
+
+    /// @brief Generates every legal move by filtering the pseudo-legal moves through isLegal.
+    /// Produces the same moves as generateLegal; kept as the reference for perft comparisons.
+    ///
+    /// @param board: Position to generate moves for.
+    /// @param moves: List the moves are appended to.
+    inline void generateLegalFiltered(const Board &board, MoveList &moves)
+    {
+        size_t first = moves.size();
+        generatePseudoLegal(board, moves);
+
+        // Compact the legal moves in place
+        size_t last = first;
+        for (size_t i = first; i < moves.size(); i++)
+        {
+            if (isLegal(board, moves[i]))
+                moves[last++] = moves[i];
+        }
+        moves.resize(last);
+    }
+
+    // ---------------------------------------------------------------------------------------
+    // Generation templated on the side to move, so pawn directions, promotion ranks and
+    // castling squares are compile-time constants
+
+    /// @brief Which legal moves generate<GenType> produces.
+    enum GenType
+    {
+        Captures, // Captures (en passant included) and promotions
+        Quiets,   // Every other move, castling included
+        Evasions, // Every move, for a side known to be in check
+        All       // Every move
+    };
+
+    /// @brief Adds one move per target square. The capture flag is known at compile time
+    /// unless both captures and quiet moves are generated.
+    template <GenType Type>
+    inline void addMoves(const Board &board, int from, Bitboard targets, MoveList &moves)
+    {
+        while (targets)
+        {
+            int to = BB::popLsb(targets);
+            if (Type == Captures)
+                moves.emplace_back(from, to, Move::Capture);
+            else if (Type == Quiets)
+                moves.emplace_back(from, to, Move::Quiet);
+            else
+                moves.emplace_back(from, to, board.Square[to] != Piece::None ? Move::Capture : Move::Quiet);
+        }
+    }
+
+    /// @brief Adds pawn moves of one shape (the destinations in targets, shifted by Step from
+    /// their origin), dropping those that would take a pinned pawn off its pin line.
+    template <int Step>
+    inline void addPawnMoves(Bitboard targets, int kind, Bitboard pinned, int king, bool promotion, MoveList &moves)
+    {
+        while (targets)
+        {
+            int to = BB::popLsb(targets);
+            int from = to - Step;
+            if ((pinned & BB::squareBB(from)) && !(Attacks::Line[king][from] & BB::squareBB(to)))
+                continue;
+            if (promotion)
+                addPromotions(from, to, kind, moves);
+            else
+                moves.emplace_back(from, to, kind);
+        }
+    }
+
+    /// @param checkMask: Squares that resolve a check, or every square when not in check.
+    template <int Us, GenType Type>
+    inline void generatePawnMoves(const Board &board, Bitboard checkMask, Bitboard pinned, int king, MoveList &moves)
+    {
+        constexpr int Them = Us ^ Piece::ColorMask;
+        constexpr int Up = Us == Piece::White ? -8 : 8;
+        constexpr int UpEast = Up + 1;
+        constexpr int UpWest = Up - 1;
+        constexpr Bitboard PromotionRank = Us == Piece::White ? BB::Rank8 : BB::Rank1;
+        constexpr Bitboard DoublePushRank = Us == Piece::White ? BB::Rank3 : BB::Rank6;
+
+        const Bitboard pawns = board.pieces(Us, Piece::Pawn);
+        const Bitboard empty = ~board.occupied;
+        const Bitboard enemies = board.pieces(Them) & checkMask;
+
+        // A double push may pass a square outside checkMask and still block on its destination
+        Bitboard single = BB::shift<Up>(pawns) & empty;
+        Bitboard doubles = BB::shift<Up>(single & DoublePushRank) & empty & checkMask;
+        single &= checkMask;
+
+        if (Type != Captures)
+        {
+            addPawnMoves<Up>(single & ~PromotionRank, Move::Quiet, pinned, king, false, moves);
+            addPawnMoves<2 * Up>(doubles, Move::DoublePush, pinned, king, false, moves);
+        }
+
+        if (Type != Quiets)
+        {
+            Bitboard east = BB::shift<UpEast>(pawns) & enemies;
+            Bitboard west = BB::shift<UpWest>(pawns) & enemies;
+            addPawnMoves<Up>(single & PromotionRank, Move::Quiet, pinned, king, true, moves);
+            addPawnMoves<UpEast>(east & PromotionRank, Move::Capture, pinned, king, true, moves);
+            addPawnMoves<UpWest>(west & PromotionRank, Move::Capture, pinned, king, true, moves);
+            addPawnMoves<UpEast>(east & ~PromotionRank, Move::Capture, pinned, king, false, moves);
+            addPawnMoves<UpWest>(west & ~PromotionRank, Move::Capture, pinned, king, false, moves);
+
+            // En passant can uncover a rank attack through two pawns, so it is tested in full
+            if (board.epSquare >= 0)
+            {
+                Bitboard capturers = Attacks::pawnAttacks<Them>(board.epSquare) & pawns;
+                while (capturers)
+                {
+                    Move move(BB::popLsb(capturers), board.epSquare, Move::EnPassant);
+                    if (isLegal(board, move))
+                        moves.push_back(move);
+                }
+            }
+        }
+    }
+
+    /// @param target: Allowed destination squares.
+    template <int Us, GenType Type>
+    inline void generatePieceMoves(const Board &board, Bitboard target, Bitboard pinned, int king, MoveList &moves)
+    {
+        Bitboard knights = board.pieces(Us, Piece::Knight) & ~pinned;
+        while (knights)
+        {
+            int from = BB::popLsb(knights);
+            addMoves<Type>(board, from, Attacks::KnightAttacks[from] & target, moves);
+        }
+
+        Bitboard diagonal = board.pieces(Us, Piece::Bishop, Piece::Queen);
+        while (diagonal)
+        {
+            int from = BB::popLsb(diagonal);
+            Bitboard attacks = Attacks::bishopAttacks(from, board.occupied) & target;
+            if (pinned & BB::squareBB(from))
+                attacks &= Attacks::Line[king][from];
+            addMoves<Type>(board, from, attacks, moves);
+        }
+
+        Bitboard straight = board.pieces(Us, Piece::Rook, Piece::Queen);
+        while (straight)
+        {
+            int from = BB::popLsb(straight);
+            Bitboard attacks = Attacks::rookAttacks(from, board.occupied) & target;
+            if (pinned & BB::squareBB(from))
+                attacks &= Attacks::Line[king][from];
+            addMoves<Type>(board, from, attacks, moves);
+        }
+    }
+
+    /// @brief Castling for a side that is not in check.
+    template <int Us>
+    inline void generateCastling(const Board &board, MoveList &moves)
+    {
+        constexpr int Them = Us ^ Piece::ColorMask;
+        constexpr int King = Us == Piece::White ? 60 : 4;
+        constexpr int KingSide = Us == Piece::White ? Castling::WhiteKingSide : Castling::BlackKingSide;
+        constexpr int QueenSide = Us == Piece::White ? Castling::WhiteQueenSide : Castling::BlackQueenSide;
+        constexpr Bitboard KingSidePath = BB::squareBB(King + 1) | BB::squareBB(King + 2);
+        constexpr Bitboard QueenSidePath = BB::squareBB(King - 1) | BB::squareBB(King - 2) | BB::squareBB(King - 3);
+
+        // A position loaded from FEN may claim rights without the king or rook in place
+        if (board.Square[King] != int(Us | Piece::King))
+            return;
+
+        if ((board.castlingRights & KingSide) && board.Square[King + 3] == int(Us | Piece::Rook) &&
+            !(board.occupied & KingSidePath) &&
+            !board.attackedBy<Them>(King + 1, board.occupied) && !board.attackedBy<Them>(King + 2, board.occupied))
+        {
+            moves.emplace_back(King, King + 2, Move::Castling);
+        }
+
+        if ((board.castlingRights & QueenSide) && board.Square[King - 4] == int(Us | Piece::Rook) &&
+            !(board.occupied & QueenSidePath) &&
+            !board.attackedBy<Them>(King - 1, board.occupied) && !board.attackedBy<Them>(King - 2, board.occupied))
+        {
+            moves.emplace_back(King, King - 2, Move::Castling);
+        }
+    }
+
+    /// @brief Generates the legal moves of the given type for side Us, which must be the
+    /// side to move. Works like generateLegalRuntime: check and pin masks instead of testing
+    /// each move, with only en passant going through isLegal.
+    template <int Us, GenType Type>
+    inline void generate(const Board &board, MoveList &moves)
+    {
+        constexpr int Them = Us ^ Piece::ColorMask;
+        const int king = board.kingSquare(Us);
+        const Bitboard enemies = board.pieces(Them);
+        const Bitboard checkers = board.attackersTo(king, board.occupied) & enemies;
+
+        const Bitboard kingTarget = Type == Captures ? enemies
+                                    : Type == Quiets ? ~board.occupied
+                                                     : ~board.pieces(Us);
+
+        // King moves, tested with the king removed so it cannot step back along a checking ray
+        const Bitboard withoutKing = board.occupied ^ BB::squareBB(king);
+        Bitboard kingTargets = Attacks::KingAttacks[king] & kingTarget;
+        while (kingTargets)
+        {
+            int to = BB::popLsb(kingTargets);
+            if (!board.attackedBy<Them>(to, withoutKing))
+                addMoves<Type>(board, king, BB::squareBB(to), moves);
+        }
+
+        if (BB::moreThanOne(checkers))
+            return;
+
+        const Bitboard checkMask = checkers ? Attacks::Between[king][BB::lsb(checkers)] | checkers : BB::All;
+        const Bitboard pinned = board.pinnedPieces(Us);
+
+        generatePawnMoves<Us, Type>(board, checkMask, pinned, king, moves);
+        generatePieceMoves<Us, Type>(board, kingTarget & checkMask, pinned, king, moves);
+
+        if (Type != Captures && Type != Evasions && !checkers &&
+            (board.castlingRights & (Us == Piece::White ? Castling::WhiteKingSide | Castling::WhiteQueenSide
+                                                         : Castling::BlackKingSide | Castling::BlackQueenSide)))
+        {
+            generateCastling<Us>(board, moves);
+        }
+    }
+
+    /// @brief Generates the legal moves of the given type for the side to move.
+    ///
+    /// @param board: Position to generate moves for.
+    /// @param moves: List the moves are appended to.
+    template <GenType Type>
+    inline void generate(const Board &board, MoveList &moves)
+    {
+        if (board.sideToMove == Piece::White)
+            generate<Piece::White, Type>(board, moves);
+        else
+            generate<Piece::Black, Type>(board, moves);
+    }
+
+    /// @brief Generates every legal move for the side to move.
+    ///
+    /// @param board: Position to generate moves for.
+    /// @param moves: List the moves are appended to.
+    inline void generateLegal(const Board &board, MoveList &moves)
+    {
+        generate<All>(board, moves);
+    }
+}
+
+#endif
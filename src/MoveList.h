@@ -0,0 +1,71 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include <cstddef>
+#include "Move.h"
+
+/// @class MoveList
+/// @brief Fixed-capacity list of moves stored inline, so generating moves never allocates.
+/// No legal chess position has more than 218 moves; 256 leaves room for pseudo-legal lists.
+class MoveList
+{
+public:
+    static constexpr size_t Capacity = 256;
+
+    void push_back(const Move &move)
+    {
+        moves[count++] = move;
+    }
+
+    template <typename... Args>
+    void emplace_back(Args... args)
+    {
+        moves[count++] = Move(args...);
+    }
+
+    /// @brief Shrinks the list to its first newSize moves.
+    void resize(size_t newSize)
+    {
+        count = newSize;
+    }
+
+    void clear()
+    {
+        count = 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    /// @brief Whether the list holds a move equal to the given one.
+    bool contains(const Move &move) const
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (moves[i] == move)
+                return true;
+        }
+        return false;
+    }
+
+    Move &operator[](size_t index) { return moves[index]; }
+    const Move &operator[](size_t index) const { return moves[index]; }
+
+    Move *begin() { return moves; }
+    Move *end() { return moves + count; }
+    const Move *begin() const { return moves; }
+    const Move *end() const { return moves + count; }
+
+private:
+    Move moves[Capacity]; // Only the first count entries are initialized
+    size_t count = 0;
+};
+
+#endif
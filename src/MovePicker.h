@@ -0,0 +1,296 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include <cstdint>
+#include <utility>
+#include "Board.h"
+#include "History.h"
+#include "Move.h"
+#include "MoveGen.h"
+#include "MoveList.h"
+#include "See.h"
+
+/// @struct PickerStats
+/// @brief Counters shared by the move pickers of a search, to see how much generation the
+/// staging saves: in a node that cuts off early, most generated moves are never searched.
+/// The search adds its beta cutoffs, whose share on the first move measures the ordering.
+struct PickerStats
+{
+    uint64_t nodes = 0;            /* Move pickers created */
+    uint64_t generated = 0;        /* Moves produced by the generator, hash move and refutations included */
+    uint64_t picked = 0;           /* Moves handed to the search */
+    uint64_t cutoffs = 0;          /* Full-width nodes that failed high */
+    uint64_t firstMoveCutoffs = 0; /* Of those, the ones that failed high on their first move */
+};
+
+/// @class MovePicker
+/// @brief Hands out the legal moves of a position one at a time, best guesses first, and
+/// only generates a stage once the previous one is used up:
+///
+/// 1. hash move
+/// 2. good captures and promotions, most valuable victim / least valuable attacker first
+/// 3. the two killer moves and the counter move
+/// 4. quiet moves, highest butterfly plus continuation history first
+/// 5. bad captures, those losing material by static exchange evaluation
+///
+/// In check all evasions are generated at once, captures first. Hash, killer and counter
+/// moves are checked against the position since they come from other nodes.
+class MovePicker
+{
+public:
+    /// @param board: Position to pick moves for. Must not change while picking.
+    /// @param ttMove: Move from the hash table, or NullMove.
+    /// @param killer1: First killer move of this ply, or NullMove.
+    /// @param killer2: Second killer move of this ply, or NullMove.
+    /// @param counterMove: Counter move to the previous move, or NullMove.
+    /// @param history: Quiet move statistics, or nullptr to keep generation order.
+    /// @param continuation1: Continuation history of the previous move, or nullptr.
+    /// @param continuation2: Continuation history of the move before it, or nullptr.
+    /// @param stats: Counters to update, or nullptr.
+    MovePicker(const Board &board, Move ttMove, Move killer1 = NullMove, Move killer2 = NullMove,
+               Move counterMove = NullMove, const SearchHistory *history = nullptr,
+               const PieceToHistory *continuation1 = nullptr, const PieceToHistory *continuation2 = nullptr,
+               PickerStats *stats = nullptr)
+        : board(board), ttMove(ttMove), history(history), continuation{continuation1, continuation2}, stats(stats)
+    {
+        refutations[0] = killer1;
+        refutations[1] = killer2 != killer1 ? killer2 : NullMove;
+        refutations[2] = counterMove != killer1 && counterMove != killer2 ? counterMove : NullMove;
+        stage = board.inCheck() ? EvasionTTMove : MainTTMove;
+        if (ttMove == NullMove || !isValid(ttMove))
+            stage++;
+        if (stats)
+            stats->nodes++;
+    }
+
+    /// @brief Move picker for the quiescence search: only captures and promotions that do not
+    /// lose material by static exchange, or every evasion when in check.
+    ///
+    /// @param board: Position to pick moves for. Must not change while picking.
+    /// @param ttMove: Move from the hash table, or NullMove. Ignored if quiet and not in check.
+    /// @param stats: Counters to update, or nullptr.
+    MovePicker(const Board &board, Move ttMove, PickerStats *stats)
+        : board(board), ttMove(ttMove), history(nullptr), continuation{nullptr, nullptr}, stats(stats), quiescence(true)
+    {
+        refutations[0] = refutations[1] = refutations[2] = NullMove;
+        bool inCheck = board.inCheck();
+        stage = inCheck ? EvasionTTMove : MainTTMove;
+        if (ttMove == NullMove || (!inCheck && !ttMove.isCapture() && !ttMove.isPromotion()) || !isValid(ttMove))
+            stage++;
+        if (stats)
+            stats->nodes++;
+    }
+
+    /// @brief Returns the next move to search, or NullMove once every legal move was returned.
+    Move next()
+    {
+        Move move = nextMove();
+        if (stats && move != NullMove)
+            stats->picked++;
+        return move;
+    }
+
+private:
+    enum Stage
+    {
+        MainTTMove,
+        GenerateCaptures,
+        GoodCaptures,
+        FirstKiller,
+        SecondKiller,
+        CounterMove,
+        GenerateQuiets,
+        Quiets,
+        BadCaptures,
+        EvasionTTMove,
+        GenerateEvasions,
+        Evasions,
+        Done
+    };
+
+    const Board &board;
+    Move ttMove;
+    Move refutations[3]; // Killers and counter move, in the order they are tried
+    const SearchHistory *history;
+    const PieceToHistory *continuation[2];
+    PickerStats *stats;
+    bool quiescence = false; // Stop after the good captures, dropping the bad ones
+    int stage;
+
+    MoveList moves;         // Moves of the current stage
+    int scores[MoveList::Capacity];
+    size_t current = 0;     // Next unpicked index into moves
+    MoveList badCaptures;   // Captures put aside until the quiet moves are done
+    size_t currentBad = 0;
+
+    bool isValid(const Move &move) const
+    {
+        if (stats)
+            stats->generated++;
+        return MoveGen::isPseudoLegal(board, move) && MoveGen::isLegal(board, move);
+    }
+
+    /// @brief Most valuable victim first, least valuable attacker among equal victims.
+    /// Promotions count the gain of the promoted piece.
+    int captureScore(const Move &move) const
+    {
+        int victim = move.isEnPassant() ? Piece::Pawn : Piece::type(board.Square[move.to()]);
+        int score = Piece::value(victim) * 16 - Piece::value(Piece::type(board.Square[move.from()])) / 64;
+        if (move.isPromotion())
+            score += Piece::value(move.promotion()) * 16;
+        return score;
+    }
+
+    /// @brief A capture is put aside when the static exchange on its square loses material.
+    bool isBadCapture(const Move &move) const
+    {
+        return !See::atLeast(board, move, 0);
+    }
+
+    int quietScore(const Move &move) const
+    {
+        if (!history)
+            return 0;
+        int score = history->butterfly[Piece::colorIndex(board.sideToMove)][move.from()][move.to()];
+        int index = History::pieceTo(board.Square[move.from()], move.to());
+        for (const PieceToHistory *table : continuation)
+        {
+            if (table)
+                score += (*table)[index];
+        }
+        return score;
+    }
+
+    /// @brief Swaps the best scoring remaining move to the front and returns it. Only the
+    /// moves actually searched get sorted.
+    Move pickBest()
+    {
+        size_t best = current;
+        for (size_t i = current + 1; i < moves.size(); i++)
+        {
+            if (scores[i] > scores[best])
+                best = i;
+        }
+        std::swap(moves[current], moves[best]);
+        std::swap(scores[current], scores[best]);
+        return moves[current++];
+    }
+
+    void startStage()
+    {
+        current = 0;
+        if (stats)
+            stats->generated += moves.size();
+    }
+
+    bool isRefutation(const Move &move) const
+    {
+        return move == refutations[0] || move == refutations[1] || move == refutations[2];
+    }
+
+    Move nextMove()
+    {
+        switch (stage)
+        {
+        case MainTTMove:
+        case EvasionTTMove:
+            stage++;
+            return ttMove;
+
+        case GenerateCaptures:
+            moves.clear();
+            MoveGen::generate<MoveGen::Captures>(board, moves);
+            for (size_t i = 0; i < moves.size(); i++)
+                scores[i] = captureScore(moves[i]);
+            startStage();
+            stage++;
+            [[fallthrough]];
+
+        case GoodCaptures:
+            while (current < moves.size())
+            {
+                Move move = pickBest();
+                if (move == ttMove)
+                    continue;
+                if (!isBadCapture(move))
+                    return move;
+                if (!quiescence)
+                    badCaptures.push_back(move);
+            }
+            if (quiescence)
+            {
+                stage = Done;
+                return NullMove;
+            }
+            stage++;
+            [[fallthrough]];
+
+        case FirstKiller:
+        case SecondKiller:
+        case CounterMove:
+            while (stage != GenerateQuiets)
+            {
+                Move refutation = refutations[stage - FirstKiller];
+                stage++;
+                // Refutations are quiet by construction, but a capture there now would be a duplicate
+                if (refutation != NullMove && refutation != ttMove && !refutation.isCapture() &&
+                    !refutation.isPromotion() && isValid(refutation))
+                    return refutation;
+            }
+            [[fallthrough]];
+
+        case GenerateQuiets:
+            moves.clear();
+            MoveGen::generate<MoveGen::Quiets>(board, moves);
+            for (size_t i = 0; i < moves.size(); i++)
+                scores[i] = quietScore(moves[i]);
+            startStage();
+            stage++;
+            [[fallthrough]];
+
+        case Quiets:
+            while (current < moves.size())
+            {
+                Move move = pickBest();
+                if (move != ttMove && !isRefutation(move))
+                    return move;
+            }
+            stage++;
+            [[fallthrough]];
+
+        case BadCaptures:
+            if (currentBad < badCaptures.size())
+                return badCaptures[currentBad++];
+            stage = Done;
+            return NullMove;
+
+        case GenerateEvasions:
+            moves.clear();
+            MoveGen::generate<MoveGen::Evasions>(board, moves);
+            for (size_t i = 0; i < moves.size(); i++)
+            {
+                // Captures of the checker before blocks and king steps
+                scores[i] = moves[i].isCapture() || moves[i].isPromotion() ? captureScore(moves[i]) + (1 << 24)
+                                                                           : quietScore(moves[i]);
+            }
+            startStage();
+            stage++;
+            [[fallthrough]];
+
+        case Evasions:
+            while (current < moves.size())
+            {
+                Move move = pickBest();
+                if (move != ttMove)
+                    return move;
+            }
+            stage = Done;
+            return NullMove;
+
+        default:
+            return NullMove;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,303 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "Board.h"
+#include "LargePages.h"
+#include "MoveGen.h"
+
+namespace Perft
+{
+    // Legal move generator used by perft, so the generators can be compared on the same tree
+    typedef void (*Generator)(const Board &, MoveList &);
+
+    /// @struct ThreadStats
+    /// @brief Work done by one perft thread, used to spot load imbalance.
+    struct ThreadStats
+    {
+        uint64_t nodes = 0;  /* Leaf nodes counted */
+        uint64_t tasks = 0;  /* Subtrees searched */
+        uint64_t probes = 0; /* Hash table lookups */
+        uint64_t hits = 0;   /* Lookups that returned a stored count */
+    };
+
+    /// @class PerftTable
+    /// @brief Lock-free cache of (key, depth) -> node count shared by all perft threads.
+    ///
+    /// Each entry is two independent atomic words: the data (count and depth) and the key
+    /// XOR'ed with the data. A reader accepts an entry only if both words XOR back to its
+    /// key, so an entry torn by two threads writing at once reads as a miss instead of a
+    /// wrong count. No locks are taken.
+    class PerftTable
+    {
+    public:
+        /// @brief Allocates the table, rounded down to a power of two number of entries.
+        ///
+        /// @param megabytes: Table size in MiB.
+        /// @return False if the memory cannot be allocated.
+        bool resize(size_t megabytes)
+        {
+            size_t count = 1;
+            while (count * 2 * sizeof(Entry) <= megabytes * 1024 * 1024)
+                count *= 2;
+
+            entryCount = entries.allocate(count) ? count : 0;
+            clear();
+            return entryCount != 0;
+        }
+
+        void clear()
+        {
+            for (size_t i = 0; i < entryCount; i++)
+            {
+                entries[i].check.store(0, std::memory_order_relaxed);
+                entries[i].data.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief Looks up the node count of a position searched to the given depth.
+        ///
+        /// @return True and the count in nodes on a hit.
+        bool probe(uint64_t key, int depth, uint64_t &nodes) const
+        {
+            const Entry &entry = entries[key & (entryCount - 1)];
+            uint64_t data = entry.data.load(std::memory_order_relaxed);
+            uint64_t check = entry.check.load(std::memory_order_relaxed);
+            if ((check ^ data) != key || (int)(data & 0xFF) != depth)
+                return false;
+            nodes = data >> 8;
+            return true;
+        }
+
+        /// @brief Stores a node count, always replacing the previous entry in the slot.
+        void store(uint64_t key, int depth, uint64_t nodes)
+        {
+            Entry &entry = entries[key & (entryCount - 1)];
+            uint64_t data = (nodes << 8) | (uint64_t)depth;
+            entry.check.store(key ^ data, std::memory_order_relaxed);
+            entry.data.store(data, std::memory_order_relaxed);
+        }
+
+        size_t size() const
+        {
+            return entryCount;
+        }
+
+        size_t sizeInBytes() const
+        {
+            return entryCount * sizeof(Entry);
+        }
+
+        LargePages::Mode pageMode() const
+        {
+            return entries.mode();
+        }
+
+        /// @brief Number of slots holding an entry. Scans the whole table.
+        size_t usedEntries() const
+        {
+            size_t used = 0;
+            for (size_t i = 0; i < entryCount; i++)
+                used += entries[i].data.load(std::memory_order_relaxed) != 0;
+            return used;
+        }
+
+    private:
+        struct Entry
+        {
+            std::atomic<uint64_t> check; /* Key XOR data */
+            std::atomic<uint64_t> data;  /* Node count << 8 | depth */
+        };
+
+        LargePages::Array<Entry> entries;
+        size_t entryCount = 0;
+    };
+
+    /// @brief Counts the leaf nodes of the legal move tree to a fixed depth.
+    /// The last ply is bulk-counted from the size of the legal move list.
+    ///
+    /// @param board: Root position.
+    /// @param depth: Remaining depth in plies.
+    /// @tparam Generate: Legal move generator, MoveGen::generateLegal unless comparing.
+    /// @return Number of leaf nodes.
+    template <Generator Generate = MoveGen::generateLegal>
+    inline uint64_t perft(Board &board, int depth)
+    {
+        if (depth == 0)
+            return 1;
+
+        MoveList moves;
+        Generate(board, moves);
+
+        if (depth == 1)
+            return moves.size();
+
+        uint64_t nodes = 0;
+        for (const Move &move : moves)
+        {
+            board.makeMove(move);
+            nodes += perft<Generate>(board, depth - 1);
+            board.unmakeMove();
+        }
+        return nodes;
+    }
+
+    /// @brief Perft that caches subtree counts in a shared table. Nodes with depth 1 are
+    /// bulk-counted and never stored.
+    ///
+    /// @param stats: Receives the probe and hit counts of this call.
+    inline uint64_t perftHashed(Board &board, int depth, PerftTable &table, ThreadStats &stats)
+    {
+        if (depth <= 1)
+            return perft(board, depth);
+
+        uint64_t key = board.key;
+        uint64_t nodes = 0;
+        stats.probes++;
+        if (table.probe(key, depth, nodes))
+        {
+            stats.hits++;
+            return nodes;
+        }
+
+        MoveList moves;
+        MoveGen::generateLegal(board, moves);
+        for (const Move &move : moves)
+        {
+            board.makeMove(move);
+            nodes += perftHashed(board, depth - 1, table, stats);
+            board.unmakeMove();
+        }
+
+        table.store(key, depth, nodes);
+        return nodes;
+    }
+
+    /// @brief Runs perft for every root move separately and prints "move: nodes" per line,
+    /// the format used to compare against other engines when tracking down a bug.
+    ///
+    /// @return Total number of leaf nodes.
+    inline uint64_t divide(Board &board, int depth, std::ostream &out = std::cout)
+    {
+        MoveList moves;
+        MoveGen::generateLegal(board, moves);
+
+        uint64_t total = 0;
+        for (const Move &move : moves)
+        {
+            board.makeMove(move);
+            uint64_t nodes = depth > 1 ? perft(board, depth - 1) : 1;
+            board.unmakeMove();
+            out << moveToString(move) << ": " << nodes << "\n";
+            total += nodes;
+        }
+        return total;
+    }
+
+    /// @struct ParallelResult
+    /// @brief Outcome of a multithreaded perft run.
+    struct ParallelResult
+    {
+        uint64_t nodes = 0;
+        MoveList rootMoves;               /* Legal moves of the root position */
+        std::vector<uint64_t> rootNodes;  /* Leaf nodes below each root move */
+        std::vector<ThreadStats> threads; /* Per-thread counters */
+    };
+
+    /// @struct Task
+    /// @brief Independent subtree handed to a perft thread.
+    struct Task
+    {
+        Board board;
+        int depth;   /* Remaining depth below board */
+        size_t root; /* Index of the root move this subtree belongs to */
+    };
+
+    /// @brief Expands the tree for a number of plies and collects the positions found there
+    /// as tasks. Splitting deeper than the root gives more, smaller tasks for better balance.
+    inline void collectTasks(Board &board, int depth, int splitDepth, size_t root, std::vector<Task> &tasks)
+    {
+        if (splitDepth == 0 || depth <= 1)
+        {
+            tasks.push_back({board, depth, root});
+            return;
+        }
+
+        MoveList moves;
+        MoveGen::generateLegal(board, moves);
+        for (const Move &move : moves)
+        {
+            board.makeMove(move);
+            collectTasks(board, depth - 1, splitDepth - 1, root, tasks);
+            board.unmakeMove();
+        }
+    }
+
+    /// @brief Perft that splits the tree into subtrees and counts them on a pool of threads.
+    /// Threads pull the next unclaimed subtree from a shared counter, so a thread that
+    /// finishes a small subtree immediately takes another one.
+    ///
+    /// @param board: Root position.
+    /// @param depth: Depth in plies, at least 1.
+    /// @param threadCount: Number of worker threads.
+    /// @param splitDepth: Plies expanded before handing out subtrees; 1 splits the root moves.
+    /// @param table: Optional hash table shared by all threads.
+    inline ParallelResult perftParallel(const Board &board, int depth, int threadCount, int splitDepth = 1, PerftTable *table = nullptr)
+    {
+        ParallelResult result;
+        MoveGen::generateLegal(board, result.rootMoves);
+        result.rootNodes.assign(result.rootMoves.size(), 0);
+        result.threads.resize(threadCount > 0 ? threadCount : 1);
+
+        std::vector<Task> tasks;
+        Board root = board;
+        for (size_t i = 0; i < result.rootMoves.size(); i++)
+        {
+            root.makeMove(result.rootMoves[i]);
+            collectTasks(root, depth - 1, splitDepth - 1, i, tasks);
+            root.unmakeMove();
+        }
+
+        std::atomic<size_t> nextTask(0);
+        // Each thread fills its own per-root counts; they are merged after joining
+        std::vector<std::vector<uint64_t>> threadRootNodes(result.threads.size(), std::vector<uint64_t>(result.rootMoves.size(), 0));
+
+        auto worker = [&](size_t threadIndex)
+        {
+            ThreadStats stats;
+            std::vector<uint64_t> &rootNodes = threadRootNodes[threadIndex];
+            // A task is claimed by exactly one thread, which may play moves on its board
+            for (size_t i = nextTask.fetch_add(1); i < tasks.size(); i = nextTask.fetch_add(1))
+            {
+                uint64_t nodes = table ? perftHashed(tasks[i].board, tasks[i].depth, *table, stats)
+                                       : perft(tasks[i].board, tasks[i].depth);
+                rootNodes[tasks[i].root] += nodes;
+                stats.nodes += nodes;
+                stats.tasks++;
+            }
+            result.threads[threadIndex] = stats;
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < result.threads.size(); t++)
+            pool.emplace_back(worker, t);
+        worker(0);
+        for (std::thread &thread : pool)
+            thread.join();
+
+        for (const std::vector<uint64_t> &rootNodes : threadRootNodes)
+        {
+            for (size_t i = 0; i < rootNodes.size(); i++)
+                result.rootNodes[i] += rootNodes[i];
+        }
+        for (uint64_t nodes : result.rootNodes)
+            result.nodes += nodes;
+        return result;
+    }
+}
+
+#endif
@@ -2,7 +2,7 @@
 #define PIECE_H
 
 namespace Piece
-{        
+{
     // 3 bits on the right will indicate the type of piece
     constexpr unsigned int None   = 0;
     constexpr unsigned int King   = 1;
@@ -14,7 +14,34 @@ namespace Piece
     // 2 bits on the left will tell us the color
     constexpr unsigned int White  = 8;
     constexpr unsigned int Black  = 16;
-}
 
-#endif 
+    constexpr unsigned int TypeMask  = 7;
+    constexpr unsigned int ColorMask = White | Black;
+
+    /// @brief Returns the type bits of a piece (Piece::King ... Piece::Knight).
+    constexpr int type(int piece)
+    {
+        return piece & TypeMask;
+    }
+
+    /// @brief Returns the color bits of a piece (Piece::White or Piece::Black).
+    constexpr int color(int piece)
+    {
+        return piece & ColorMask;
+    }
+
+    /// @brief Material value of a piece type in centipawns. The king has no material value.
+    constexpr int value(int type)
+    {
+        constexpr int values[7] = {0, 0, 900, 330, 500, 100, 320};
+        return values[type];
+    }
+
+    /// @brief Maps Piece::White to 0 and Piece::Black to 1, for indexing per-color tables.
+    constexpr int colorIndex(int color)
+    {
+        return color >> 4;
+    }
+}
 
+#endif
@@ -0,0 +1,642 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include "Board.h"
+#include "Evaluate.h"
+#include "Move.h"
+#include "MoveGen.h"
+#include "MoveList.h"
+#include "MovePicker.h"
+#include "TranspositionTable.h"
+
+namespace Search
+{
+    constexpr int MaxPly = 128;
+    constexpr int Infinite = 32000;
+    // Mate in n plies scores MateScore - n; anything beyond MateBound is a forced mate
+    constexpr int MateScore = 31000;
+    constexpr int MateBound = MateScore - MaxPly;
+    // Depth of quiescence entries in the transposition table, below every full-width search
+    constexpr int QuiescenceDepth = 0;
+
+    /// @brief Formats a score the way engines report it: "cp 35", "mate 3" or "mate -2"
+    /// (mated in two moves).
+    inline std::string scoreToString(int score)
+    {
+        if (score > MateBound)
+            return "mate " + std::to_string((MateScore - score + 1) / 2);
+        if (score < -MateBound)
+            return "mate -" + std::to_string((MateScore + score) / 2);
+        return "cp " + std::to_string(score);
+    }
+
+    /// @brief Converts a mate score from "mate in n plies from the root" to "mate in n plies
+    /// from this node" for the transposition table, where the entry may be reached at any ply.
+    inline int scoreToTT(int score, int ply)
+    {
+        return score > MateBound ? score + ply : score < -MateBound ? score - ply : score;
+    }
+
+    /// @brief Inverse of scoreToTT.
+    inline int scoreFromTT(int score, int ply)
+    {
+        return score > MateBound ? score - ply : score < -MateBound ? score + ply : score;
+    }
+
+    /// @struct Limits
+    /// @brief When to stop searching. Every limit left at 0 is ignored; depth 1 always completes.
+    struct Limits
+    {
+        int depth = MaxPly - 1; /* Deepest iteration */
+        int64_t moveTimeMs = 0; /* Wall-clock budget in milliseconds, time spent pondering included */
+        uint64_t nodes = 0;     /* Node budget */
+        bool ponder = false;    /* Ignore the time and node limits until ponderHit() */
+    };
+
+    /// @struct Options
+    /// @brief Selective search techniques, each of which can be switched off to measure what
+    /// it saves in nodes and costs in accuracy on the fixed bench.
+    struct Options
+    {
+        bool nullMove = true;           /* Null-move pruning */
+        bool lateMoveReductions = true; /* Shallower search of late quiet moves */
+        bool reverseFutility = true;    /* Cut nodes whose static evaluation is far above beta */
+        bool futility = true;           /* Skip quiet moves that cannot lift a static evaluation far below alpha */
+    };
+
+    /// @struct SharedState
+    /// @brief What the threads of one search share besides the transposition table. A lone
+    /// Searcher uses its own copy, the threads of a ThreadPool point to the pool's.
+    struct SharedState
+    {
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> nodes{0};        /* Node total, updated every 1024 nodes per thread */
+        std::atomic<bool> pondering{false}; /* The time and node limits are suspended */
+
+        void reset(bool ponder)
+        {
+            stop.store(false, std::memory_order_relaxed);
+            nodes.store(0, std::memory_order_relaxed);
+            pondering.store(ponder, std::memory_order_relaxed);
+        }
+
+        bool isPondering() const
+        {
+            return pondering.load(std::memory_order_relaxed);
+        }
+    };
+
+    /// @struct Result
+    /// @brief Best line found by the last completed iteration.
+    struct Result
+    {
+        Move bestMove = NullMove;
+        int score = 0;      /* Centipawns from the side to move's point of view, or a mate score */
+        int depth = 0;      /* Depth of the last completed iteration */
+        uint64_t nodes = 0; /* Nodes searched so far, quiescence included */
+        double seconds = 0.0;
+        MoveList pv;        /* Principal variation, starting with bestMove */
+        uint64_t ttProbes = 0;
+        uint64_t ttHits = 0;
+        int hashfull = 0;   /* Permille of the transposition table written by this search */
+    };
+
+    // Called after every completed iteration, e.g. to print progress
+    typedef std::function<void(const Result &)> IterationCallback;
+
+    class ThreadPool;
+
+    /// @class Searcher
+    /// @brief Iterative-deepening negamax alpha-beta with principal variation search and a
+    /// quiescence search over captures. The transposition table supplies the best move of
+    /// the previous iteration first, which makes most of the tree a cheap null-window proof,
+    /// and cuts off positions already searched deeply enough.
+    ///
+    /// Outside the principal variation the tree is pruned selectively (see Options): null-move
+    /// pruning, reverse futility and futility pruning near the leaves, and late move reductions.
+    ///
+    /// Quiet moves are ordered by the killer, counter move and history tables of SearchHistory,
+    /// which carry over from one search to the next, aged rather than cleared.
+    ///
+    /// A Searcher is large (it holds a board, the PV table and the history tables, over 2 MiB);
+    /// create it once on the heap and reuse it. Several searchers on the same table form a
+    /// Lazy SMP search, see ThreadPool.
+    class Searcher
+    {
+    public:
+        /// @param table: Transposition table, may be shared with other searchers.
+        /// @param threadIndex: 0 for the main thread, which alone enforces the limits;
+        /// helper threads skip some depths so they do not all search the same tree.
+        explicit Searcher(TranspositionTable &table, int threadIndex = 0)
+            : tt(table), threadIndex(threadIndex)
+        {
+            history.clear();
+            // Reductions grow with the logarithms of both the depth and the move number
+            for (int depth = 1; depth < 64; depth++)
+                for (int move = 1; move < 64; move++)
+                    reductions[depth][move] = (uint8_t)(0.75 + std::log(depth) * std::log(move) / 2.25);
+        }
+
+        /// @brief Switches selective search techniques on or off. Not while searching.
+        void setOptions(const Options &options)
+        {
+            this->options = options;
+        }
+
+        /// @brief Searches a position until a limit is reached or stop() is called.
+        ///
+        /// @param root: Position to search; it has to have at least one legal move.
+        /// @param limits: Depth, time and node limits.
+        /// @param onIteration: Optional callback run after every completed iteration.
+        /// @return Best move, score, depth, node count and principal variation.
+        Result search(const Board &root, const Limits &limits, const IterationCallback &onIteration = nullptr)
+        {
+            shared->reset(limits.ponder);
+            tt.newSearch();
+            return iterate(root, limits, onIteration);
+        }
+
+        /// @brief Asks a running search to return as soon as possible. Safe to call from
+        /// another thread; stops every thread of a ThreadPool.
+        void stop()
+        {
+            shared->stop.store(true, std::memory_order_relaxed);
+        }
+
+        /// @brief The move pondered on was played: the search continues as a normal one.
+        /// The time spent pondering counts against the time limit, so a long ponder hit is
+        /// answered at once with a deeper search than the budget alone would reach. Safe to
+        /// call from another thread.
+        void ponderHit()
+        {
+            shared->pondering.store(false, std::memory_order_relaxed);
+        }
+
+        /// @brief Forgets the move ordering statistics, for a new game. Not while searching.
+        void clearHistory()
+        {
+            history.clear();
+        }
+
+        /// @brief Move picker counters of the last search: moves generated versus searched.
+        const PickerStats &moveStats() const
+        {
+            return pickerStats;
+        }
+
+    private:
+        friend class ThreadPool;
+
+        // Helper thread i (1-based) searches a depth only if ((depth + SkipPhase) / SkipSize)
+        // is even for its entry i - 1, so at any time the helpers are spread over the current
+        // and the next depths instead of racing through the same iteration
+        static constexpr int SkipSize[20] = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+        static constexpr int SkipPhase[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+        static_assert(MaxPly <= History::KillerPlies, "Every ply needs killer slots");
+        // Quiet moves remembered per node for the history malus; later ones get none
+        static constexpr int MaxQuietsTried = 64;
+        // Stack entries before the root, so ply - 1 and ply - 2 are always valid
+        static constexpr int StackOffset = 2;
+        // Deepest nodes pruned by their static evaluation, and the margins per ply of depth
+        static constexpr int ReverseFutilityDepth = 6;
+        static constexpr int ReverseFutilityMargin = 80;
+        static constexpr int FutilityDepth = 4;
+        static constexpr int FutilityBase = 100;
+        static constexpr int FutilityMargin = 120;
+
+        /// @struct StackEntry
+        /// @brief The move made at a ply, as the following plies see it.
+        struct StackEntry
+        {
+            int pieceTo;                  /* History::pieceTo of the move, -1 before the root or for a null move */
+            PieceToHistory *continuation; /* Continuation history of the move, nullptr before the root or for a null move */
+        };
+
+        TranspositionTable &tt;
+        const int threadIndex;
+        Board board;
+        Limits limits;
+        std::chrono::steady_clock::time_point startTime;
+        SharedState ownShared;
+        SharedState *shared = &ownShared; // Redirected to the pool's when searching with helpers
+        uint64_t nodes = 0;
+        uint64_t ttProbes = 0;
+        uint64_t ttHits = 0;
+        int rootDepth = 0;
+        int maxPly = MaxPly; // Plies the root's undo stack has room for, at most MaxPly
+        PickerStats pickerStats;
+        SearchHistory history;
+        StackEntry stack[MaxPly + StackOffset];
+        Options options;
+        uint8_t reductions[64][64]; // Late move reduction by depth and move number, both capped at 63
+
+        // Triangular PV table: row ply holds the best line found from that ply on
+        Move pvTable[MaxPly][MaxPly];
+        int pvLength[MaxPly];
+
+        bool skipsDepth(int depth) const
+        {
+            if (threadIndex == 0)
+                return false;
+            int i = (threadIndex - 1) % 20;
+            return ((depth + SkipPhase[i]) / SkipSize[i]) % 2 != 0;
+        }
+
+        /// @brief The iterative deepening loop, without resetting the state shared with other
+        /// threads: the stop flag, the node total and the table generation.
+        Result iterate(const Board &root, const Limits &limits, const IterationCallback &onIteration)
+        {
+            board = root;
+            this->limits = limits;
+            startTime = std::chrono::steady_clock::now();
+            nodes = 0;
+            ttProbes = 0;
+            ttHits = 0;
+            pickerStats = PickerStats();
+            // The search plays its moves on top of the game on the same undo stack
+            maxPly = std::min(MaxPly, Board::MaxHistory - root.historySize);
+            history.age();
+            for (int i = 0; i < StackOffset; i++)
+                stack[i] = {-1, nullptr};
+
+            Result result;
+            for (int depth = 1; depth <= limits.depth && depth < MaxPly; depth++)
+            {
+                // Helpers always finish depth 1, which gives them a result to offer
+                if (depth > 1 && skipsDepth(depth))
+                    continue;
+                rootDepth = depth;
+                int score = negamax(-Infinite, Infinite, depth, 0);
+
+                // An interrupted iteration is not trusted, except that it is all there is
+                if (isStopped() && result.bestMove != NullMove)
+                    break;
+
+                result.score = score;
+                result.depth = depth;
+                result.pv.clear();
+                for (int i = 0; i < pvLength[0]; i++)
+                    result.pv.push_back(pvTable[0][i]);
+                result.bestMove = result.pv.empty() ? NullMove : result.pv[0];
+                result.nodes = nodes;
+                result.seconds = elapsedSeconds();
+                result.ttProbes = ttProbes;
+                result.ttHits = ttHits;
+                result.hashfull = tt.hashfull();
+
+                if (onIteration)
+                    onIteration(result);
+                if (isStopped())
+                    break;
+                // The next iteration takes several times longer, do not start what cannot finish
+                if (threadIndex == 0 && limits.moveTimeMs && !shared->isPondering() &&
+                    elapsedSeconds() * 1000.0 * 2 > limits.moveTimeMs)
+                    break;
+            }
+
+            // A ponder search that ran out of depth still has to wait: its move may only be
+            // played after the ponder hit
+            while (threadIndex == 0 && shared->isPondering() && !isStopped())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            // Stopped before the first move of depth 1 was searched: any legal move will do
+            if (result.bestMove == NullMove)
+            {
+                MoveList moves;
+                MoveGen::generateLegal(board, moves);
+                if (!moves.empty())
+                {
+                    result.bestMove = moves[0];
+                    result.pv.push_back(moves[0]);
+                }
+            }
+            result.nodes = nodes;
+            result.seconds = elapsedSeconds();
+            result.ttProbes = ttProbes;
+            result.ttHits = ttHits;
+            result.hashfull = tt.hashfull();
+            return result;
+        }
+
+        double elapsedSeconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        bool isStopped() const
+        {
+            return shared->stop.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Every 1024 nodes, adds them to the node total and, on the main thread,
+        /// checks the time and node limits unless pondering. The first iteration always
+        /// completes so there is a move to play.
+        void checkLimits()
+        {
+            if ((nodes & 1023) != 0)
+                return;
+            uint64_t total = shared->nodes.fetch_add(1024, std::memory_order_relaxed) + 1024;
+            if (threadIndex != 0 || rootDepth == 1 || shared->isPondering())
+                return;
+            if ((limits.nodes && total >= limits.nodes) ||
+                (limits.moveTimeMs && elapsedSeconds() * 1000.0 >= limits.moveTimeMs))
+                stop();
+        }
+
+        bool probe(TranspositionTable::Data &data)
+        {
+            ttProbes++;
+            if (!tt.probe(board.key, data))
+                return false;
+            ttHits++;
+            return true;
+        }
+
+        /// @brief Whether a stored bound settles the score of a node searched with the
+        /// window (alpha, beta).
+        static bool isCutoff(const TranspositionTable::Data &data, int alpha, int beta, int ply)
+        {
+            int score = scoreFromTT(data.score, ply);
+            return data.bound == TranspositionTable::BoundExact ||
+                   (data.bound == TranspositionTable::BoundLower && score >= beta) ||
+                   (data.bound == TranspositionTable::BoundUpper && score <= alpha);
+        }
+
+        /// @brief Rewards a quiet move that caused a beta cutoff and penalizes the quiet moves
+        /// searched before it in vain, in the butterfly and continuation histories, and makes
+        /// it a killer of the ply and the counter move of the previous move.
+        void updateQuietHistory(int ply, int depth, const Move &best, const Move *quiets, int quietCount)
+        {
+            Move *killers = history.killers[ply];
+            if (killers[0] != best)
+            {
+                killers[1] = killers[0];
+                killers[0] = best;
+            }
+            const StackEntry *entry = &stack[ply + StackOffset];
+            if (entry[-1].pieceTo >= 0)
+                history.counterMoves[entry[-1].pieceTo] = best;
+
+            const int bonus = History::bonus(depth);
+            const int side = Piece::colorIndex(board.sideToMove);
+            for (int i = 0; i < quietCount; i++)
+            {
+                const Move &move = quiets[i];
+                const int change = move == best ? bonus : -bonus;
+                const int index = History::pieceTo(board.Square[move.from()], move.to());
+                History::update(history.butterfly[side][move.from()][move.to()], change);
+                for (int back = 1; back <= 2; back++)
+                {
+                    if (entry[-back].continuation)
+                        History::update((*entry[-back].continuation)[index], change);
+                }
+            }
+        }
+
+        /// @brief Copies the line below ply into the PV of ply, behind move.
+        void updatePv(int ply, const Move &move)
+        {
+            pvTable[ply][ply] = move;
+            for (int i = ply + 1; i < pvLength[ply + 1]; i++)
+                pvTable[ply][i] = pvTable[ply + 1][i];
+            pvLength[ply] = pvLength[ply + 1];
+        }
+
+        int negamax(int alpha, int beta, int depth, int ply)
+        {
+            pvLength[ply] = ply;
+            if (depth <= 0)
+                return quiescence(alpha, beta, ply);
+
+            nodes++;
+            checkLimits();
+            if (isStopped())
+                return 0;
+
+            if (ply > 0 && board.isDraw())
+                return 0;
+            if (ply >= maxPly - 1)
+                return Eval::evaluate(board);
+
+            const bool pvNode = beta - alpha > 1;
+            const bool inCheck = board.inCheck();
+            // Check extension: never enter the quiescence search in check
+            if (inCheck)
+                depth++;
+
+            TranspositionTable::Data ttData;
+            const bool ttHit = probe(ttData);
+            const Move ttMove = ttHit ? ttData.move : NullMove;
+            // Outside the principal variation a deep enough bound ends the search of the node
+            if (!pvNode && ttHit && ttData.depth >= depth && isCutoff(ttData, alpha, beta, ply))
+                return scoreFromTT(ttData.score, ply);
+
+            const int staticEval = inCheck ? 0 : ttHit ? ttData.eval : Eval::evaluate(board);
+            const int originalAlpha = alpha;
+            StackEntry *entry = &stack[ply + StackOffset];
+
+            if (!pvNode && !inCheck)
+            {
+                // Reverse futility: so far above beta that no move is likely to bring it back
+                if (options.reverseFutility && depth <= ReverseFutilityDepth && std::abs(beta) < MateBound &&
+                    staticEval - ReverseFutilityMargin * depth >= beta)
+                    return staticEval;
+
+                // Null move: if passing still fails high, a real move will too. Not twice in a
+                // row, and not with pawns only, where zugzwang makes passing the better option
+                if (options.nullMove && depth >= 3 && staticEval >= beta && entry[-1].pieceTo >= 0 &&
+                    board.hasNonPawnMaterial(board.sideToMove))
+                {
+                    const int reduction = 3 + depth / 6;
+                    *entry = {-1, nullptr};
+                    board.makeNullMove();
+                    int score = -negamax(-beta, -beta + 1, depth - 1 - reduction, ply + 1);
+                    board.unmakeNullMove();
+                    if (isStopped())
+                        return 0;
+                    // A mate found after passing is not a proven one
+                    if (score >= beta)
+                        return score > MateBound ? beta : score;
+                }
+            }
+
+            // Futility: quiet moves cannot lift a static evaluation this far below alpha
+            const bool futile = options.futility && !pvNode && !inCheck && depth <= FutilityDepth &&
+                                std::abs(alpha) < MateBound && staticEval + FutilityBase + FutilityMargin * depth <= alpha;
+            const Move counterMove = entry[-1].pieceTo >= 0 ? history.counterMoves[entry[-1].pieceTo] : NullMove;
+            MovePicker picker(board, ttMove, history.killers[ply][0], history.killers[ply][1], counterMove,
+                              &history, entry[-1].continuation, entry[-2].continuation, &pickerStats);
+
+            int bestScore = -Infinite;
+            Move bestMove = NullMove;
+            int moveCount = 0;
+            Move quiets[MaxQuietsTried];
+            int quietCount = 0;
+            for (Move move = picker.next(); move != NullMove; move = picker.next())
+            {
+                const bool quiet = !move.isCapture() && !move.isPromotion();
+                entry->pieceTo = History::pieceTo(board.Square[move.from()], move.to());
+                entry->continuation = &history.continuation[entry->pieceTo];
+                board.makeMove(move);
+                const bool givesCheck = board.inCheck();
+
+                // Once a move has been searched, so there is a score to return
+                if (futile && quiet && !givesCheck && bestScore > -MateBound)
+                {
+                    board.unmakeMove();
+                    continue;
+                }
+
+                moveCount++;
+                if (quiet && quietCount < MaxQuietsTried)
+                    quiets[quietCount++] = move;
+
+                int score;
+                if (moveCount == 1)
+                {
+                    score = -negamax(-beta, -alpha, depth - 1, ply + 1);
+                }
+                else
+                {
+                    // Late quiet moves are rarely best: search them shallower first, and only
+                    // at full depth if they turn out better than expected
+                    int reduction = 0;
+                    if (options.lateMoveReductions && depth >= 3 && moveCount > 1 + pvNode && quiet && !inCheck && !givesCheck)
+                    {
+                        reduction = reductions[std::min(depth, 63)][std::min(moveCount, 63)] - pvNode;
+                        reduction = std::max(0, std::min(reduction, depth - 2));
+                    }
+
+                    // Prove with a null window that the move is no better than the best so far,
+                    // and only search it fully when that fails
+                    score = -negamax(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
+                    if (reduction > 0 && score > alpha)
+                        score = -negamax(-alpha - 1, -alpha, depth - 1, ply + 1);
+                    if (score > alpha && score < beta)
+                        score = -negamax(-beta, -alpha, depth - 1, ply + 1);
+                }
+
+                board.unmakeMove();
+                if (isStopped())
+                    return 0;
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    if (score > alpha)
+                    {
+                        alpha = score;
+                        bestMove = move;
+                        updatePv(ply, move);
+                        if (alpha >= beta)
+                        {
+                            pickerStats.cutoffs++;
+                            if (moveCount == 1)
+                                pickerStats.firstMoveCutoffs++;
+                            if (quiet)
+                                updateQuietHistory(ply, depth, move, quiets, quietCount);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if (moveCount == 0)
+                return inCheck ? -MateScore + ply : 0;
+
+            TranspositionTable::Bound bound = bestScore >= beta         ? TranspositionTable::BoundLower
+                                              : alpha > originalAlpha ? TranspositionTable::BoundExact
+                                                                      : TranspositionTable::BoundUpper;
+            tt.store(board.key, depth, scoreToTT(bestScore, ply), staticEval, bound, bestMove);
+            return bestScore;
+        }
+
+        /// @brief Searches captures only until the position is quiet, so the static
+        /// evaluation is never taken in the middle of an exchange.
+        int quiescence(int alpha, int beta, int ply)
+        {
+            pvLength[ply] = ply;
+            nodes++;
+            checkLimits();
+            if (isStopped())
+                return 0;
+
+            if (ply >= maxPly - 1)
+                return Eval::evaluate(board);
+
+            const bool pvNode = beta - alpha > 1;
+            const bool inCheck = board.inCheck();
+
+            TranspositionTable::Data ttData;
+            const bool ttHit = probe(ttData);
+            if (!pvNode && ttHit && isCutoff(ttData, alpha, beta, ply))
+                return scoreFromTT(ttData.score, ply);
+
+            const int originalAlpha = alpha;
+            int staticEval = 0;
+            int bestScore = -Infinite;
+            if (!inCheck)
+            {
+                // Stand pat: the side to move can usually do at least as well as doing nothing
+                staticEval = ttHit ? ttData.eval : Eval::evaluate(board);
+                bestScore = staticEval;
+                if (bestScore >= beta)
+                {
+                    if (!ttHit)
+                        tt.store(board.key, QuiescenceDepth, scoreToTT(bestScore, ply), staticEval,
+                                 TranspositionTable::BoundLower, NullMove);
+                    return bestScore;
+                }
+                if (bestScore > alpha)
+                    alpha = bestScore;
+            }
+
+            MovePicker picker(board, ttHit ? ttData.move : NullMove, &pickerStats);
+            Move bestMove = NullMove;
+            int moveCount = 0;
+            for (Move move = picker.next(); move != NullMove; move = picker.next())
+            {
+                board.makeMove(move);
+                moveCount++;
+                int score = -quiescence(-beta, -alpha, ply + 1);
+                board.unmakeMove();
+                if (isStopped())
+                    return 0;
+
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    if (score > alpha)
+                    {
+                        alpha = score;
+                        bestMove = move;
+                        updatePv(ply, move);
+                        if (alpha >= beta)
+                            break;
+                    }
+                }
+            }
+
+            if (inCheck && moveCount == 0)
+                return -MateScore + ply;
+
+            TranspositionTable::Bound bound = bestScore >= beta         ? TranspositionTable::BoundLower
+                                              : alpha > originalAlpha ? TranspositionTable::BoundExact
+                                                                      : TranspositionTable::BoundUpper;
+            tt.store(board.key, QuiescenceDepth, scoreToTT(bestScore, ply), staticEval, bound, bestMove);
+            return bestScore;
+        }
+    };
+}
+
+#endif
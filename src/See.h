@@ -0,0 +1,143 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include "Attacks.h"
+#include "Bitboard.h"
+#include "Board.h"
+#include "Move.h"
+#include "Piece.h"
+
+namespace See
+{
+    /// @brief Finds the least valuable piece among attackers, or Piece::None if there is none.
+    ///
+    /// @param square: Receives the square of the piece.
+    inline int leastValuable(const Board &board, Bitboard attackers, int &square)
+    {
+        static constexpr int order[6] = {Piece::Pawn, Piece::Knight, Piece::Bishop, Piece::Rook, Piece::Queen, Piece::King};
+        for (int type : order)
+        {
+            Bitboard pieces = attackers & board.typeBB[type];
+            if (pieces)
+            {
+                square = BB::lsb(pieces);
+                return type;
+            }
+        }
+        return Piece::None;
+    }
+
+    /// @brief Static exchange evaluation: tests whether the exchange started by a move on its
+    /// destination square gains at least threshold centipawns for the side making it, with
+    /// both sides always recapturing with their least valuable piece and free to stop.
+    ///
+    /// Only bitboards are used and the board is not modified. Sliders behind a capturing
+    /// piece join in as x-rays once it leaves. Pins are ignored. Stops as soon as the result
+    /// is decided, so most calls look at one or two captures.
+    ///
+    /// @param board: Position before the move.
+    /// @param move: Move to test, usually a capture.
+    /// @param threshold: Minimum material gain in centipawns.
+    /// @return True if the exchange gains at least threshold.
+    inline bool atLeast(const Board &board, const Move &move, int threshold)
+    {
+        // Castling never puts material en prise in a way worth evaluating here
+        if (move.isCastling())
+            return 0 >= threshold;
+
+        const int from = move.from(), to = move.to();
+        int moving = Piece::type(board.Square[from]);
+        int captured = move.isEnPassant() ? Piece::Pawn : Piece::type(board.Square[to]);
+
+        // Gain if the opponent does not recapture
+        int balance = Piece::value(captured) - threshold;
+        if (move.isPromotion())
+        {
+            balance += Piece::value(move.promotion()) - Piece::value(Piece::Pawn);
+            moving = move.promotion();
+        }
+        if (balance < 0)
+            return false;
+
+        // Gain if the opponent recaptures the moved piece for free
+        balance = Piece::value(moving) - balance;
+        if (balance <= 0)
+            return true;
+
+        Bitboard occupancy = board.occupied ^ BB::squareBB(from) ^ BB::squareBB(to);
+        if (move.isEnPassant())
+            occupancy ^= BB::squareBB(board.captureSquare(move));
+
+        const Bitboard diagonal = board.typeBB[Piece::Bishop] | board.typeBB[Piece::Queen];
+        const Bitboard straight = board.typeBB[Piece::Rook] | board.typeBB[Piece::Queen];
+        Bitboard attackers = board.attackersTo(to, occupancy) & occupancy;
+
+        int side = Piece::color(board.Square[from]);
+        // 1 while the side that made the move comes out ahead
+        bool result = true;
+
+        while (true)
+        {
+            side ^= Piece::ColorMask;
+            attackers &= occupancy;
+            Bitboard sideAttackers = attackers & board.pieces(side);
+            if (!sideAttackers)
+                break;
+
+            int square = 0;
+            int type = leastValuable(board, sideAttackers, square);
+            result = !result;
+
+            // The king may only capture last, when nothing defends the square anymore
+            if (type == Piece::King)
+                return (attackers & ~board.pieces(side)) ? !result : result;
+
+            // Balance from the point of view of the side about to capture
+            balance = Piece::value(type) - balance;
+            if (balance < (int)result)
+                break;
+
+            occupancy ^= BB::squareBB(square);
+            if (type == Piece::Pawn || type == Piece::Bishop || type == Piece::Queen)
+                attackers |= Attacks::bishopAttacks(to, occupancy) & diagonal;
+            if (type == Piece::Rook || type == Piece::Queen)
+                attackers |= Attacks::rookAttacks(to, occupancy) & straight;
+        }
+        return result;
+    }
+
+    /// @brief Pieces of a color, king excepted, that the opponent can capture with a
+    /// profitable exchange. Used to highlight hanging pieces. Only legal first captures
+    /// count: pinned attackers must stay on their pin line, and the king may only take
+    /// an undefended piece.
+    inline Bitboard hangingPieces(const Board &board, int color)
+    {
+        const int them = color ^ Piece::ColorMask;
+        const int theirKing = board.kingSquare(them);
+        const Bitboard pinned = board.pinnedPieces(them);
+        Bitboard hanging = BB::Empty;
+        Bitboard targets = board.pieces(color) & ~board.pieces(color, Piece::King);
+        while (targets)
+        {
+            int square = BB::popLsb(targets);
+            Bitboard defended = board.attackersTo(square, board.occupied) & board.pieces(color);
+            Bitboard attackers = board.attackersTo(square, board.occupied) & board.pieces(them);
+            while (attackers)
+            {
+                int from = BB::popLsb(attackers);
+                if (from == theirKing && defended)
+                    continue;
+                if ((pinned & BB::squareBB(from)) && !(Attacks::Line[theirKing][from] & BB::squareBB(square)))
+                    continue;
+                if (atLeast(board, Move(from, square, Move::Capture), 1))
+                {
+                    hanging |= BB::squareBB(square);
+                    break;
+                }
+            }
+        }
+        return hanging;
+    }
+}
+
+#endif
@@ -96,6 +96,15 @@ public:
         glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
     }
 
+    /// @brief Sets an unsigned integer uniform in the shader.
+    ///
+    /// @param name: Name of the uniform variable.
+    /// @param value: Unsigned integer value to set.
+    void setUInt(const std::string &name, unsigned int value) const
+    {
+        glUniform1ui(glGetUniformLocation(ID, name.c_str()), value);
+    }
+
     /// @brief Sets a float uniform in the shader.
     ///
     /// @param name: Name of the uniform variable.
@@ -0,0 +1,55 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/// @class SpscQueue
+/// @brief Fixed-capacity ring buffer for exactly one producer thread and one consumer
+/// thread. Neither side ever blocks or takes a lock: push() fails when the queue is full
+/// and pop() fails when it is empty, so a render loop can drain it every frame for free.
+///
+/// @tparam T: Element type, copied in and out; keep it trivially copyable.
+/// @tparam Capacity: Number of slots, a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    /// @brief Appends an item. Producer thread only.
+    ///
+    /// @return False, leaving the queue unchanged, if it is full.
+    bool push(const T &item)
+    {
+        size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - headIndex.load(std::memory_order_acquire) == Capacity)
+            return false;
+        items[tail & (Capacity - 1)] = item;
+        // Publishes the item: the consumer sees the new tail only after the write above
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Removes the oldest item. Consumer thread only.
+    ///
+    /// @return False if the queue is empty.
+    bool pop(T &item)
+    {
+        size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire))
+            return false;
+        item = items[head & (Capacity - 1)];
+        // Hands the slot back to the producer only after it has been read
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // Each index on its own cache line so producer and consumer do not invalidate each other
+    alignas(64) std::atomic<size_t> headIndex{0};
+    alignas(64) std::atomic<size_t> tailIndex{0};
+    T items[Capacity];
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Board.h"
+#include "Search.h"
+#include "TranspositionTable.h"
+
+namespace Search
+{
+    /// @class ThreadPool
+    /// @brief Lazy SMP: every thread searches the same root with its own Searcher, and the
+    /// threads only cooperate through the shared transposition table. Helpers fill the table
+    /// with results the main thread then finds ready, and skip depths (Searcher::skipsDepth)
+    /// so they work ahead of it rather than on the same nodes.
+    ///
+    /// The calling thread is the main thread; helper threads live for one search.
+    class ThreadPool
+    {
+    public:
+        /// @param table: Transposition table shared by all threads.
+        /// @param threadCount: Number of search threads, main thread included.
+        explicit ThreadPool(TranspositionTable &table, int threadCount = 1)
+            : tt(table)
+        {
+            setThreadCount(threadCount);
+        }
+
+        /// @brief Changes the number of threads. Not allowed while searching.
+        void setThreadCount(int threadCount)
+        {
+            if (threadCount < 1)
+                threadCount = 1;
+            searchers.clear();
+            for (int i = 0; i < threadCount; i++)
+            {
+                searchers.emplace_back(new Searcher(tt, i));
+                searchers.back()->shared = &shared;
+                searchers.back()->setOptions(options);
+            }
+        }
+
+        /// @brief Switches selective search techniques on or off in every thread, including
+        /// those created later. Not allowed while searching.
+        void setOptions(const Options &options)
+        {
+            this->options = options;
+            for (const std::unique_ptr<Searcher> &searcher : searchers)
+                searcher->setOptions(options);
+        }
+
+        int threadCount() const
+        {
+            return (int)searchers.size();
+        }
+
+        /// @brief Searches with all threads until the main thread reaches a limit or stop()
+        /// is called, then stops the helpers.
+        ///
+        /// @param onIteration: Called by the main thread after each of its iterations, with
+        /// the node count of all threads.
+        /// @return The result of the thread that completed the deepest iteration, the best score
+        /// breaking ties between equally deep ones, with nodes and table counters summed over
+        /// all threads.
+        Result search(const Board &root, const Limits &limits, const IterationCallback &onIteration = nullptr)
+        {
+            shared.reset(limits.ponder);
+            tt.newSearch();
+
+            // Helpers have no limit but depth; the main thread stops them
+            Limits helperLimits;
+            helperLimits.depth = limits.depth;
+
+            std::vector<Result> results(searchers.size());
+            std::vector<std::thread> helpers;
+            for (size_t i = 1; i < searchers.size(); i++)
+                helpers.emplace_back([&, i]() { results[i] = searchers[i]->iterate(root, helperLimits, nullptr); });
+
+            IterationCallback report;
+            if (onIteration)
+            {
+                report = [&](const Result &iteration)
+                {
+                    Result total = iteration;
+                    total.nodes = shared.nodes.load(std::memory_order_relaxed);
+                    onIteration(total);
+                };
+            }
+            results[0] = searchers[0]->iterate(root, limits, report);
+
+            shared.stop.store(true, std::memory_order_relaxed);
+            for (std::thread &helper : helpers)
+                helper.join();
+
+            // Scores of different depths do not compare: a deeper iteration wins even if it
+            // found the main thread's line to be worse
+            Result best = results[0];
+            for (size_t i = 1; i < results.size(); i++)
+            {
+                if (results[i].bestMove != NullMove &&
+                    (results[i].depth > best.depth || (results[i].depth == best.depth && results[i].score > best.score)))
+                {
+                    best.bestMove = results[i].bestMove;
+                    best.score = results[i].score;
+                    best.depth = results[i].depth;
+                    best.pv = results[i].pv;
+                }
+            }
+            best.nodes = 0;
+            best.ttProbes = 0;
+            best.ttHits = 0;
+            for (const Result &result : results)
+            {
+                best.nodes += result.nodes;
+                best.ttProbes += result.ttProbes;
+                best.ttHits += result.ttHits;
+            }
+            return best;
+        }
+
+        /// @brief Forgets the move ordering statistics of every thread, for a new game or a
+        /// reproducible benchmark. Not allowed while searching.
+        void clearHistory()
+        {
+            for (const std::unique_ptr<Searcher> &searcher : searchers)
+                searcher->clearHistory();
+        }
+
+        /// @brief Stops a running search. Safe to call from another thread.
+        void stop()
+        {
+            shared.stop.store(true, std::memory_order_relaxed);
+        }
+
+        /// @brief Turns a ponder search into a normal one (see Searcher::ponderHit). Safe to
+        /// call from another thread.
+        void ponderHit()
+        {
+            shared.pondering.store(false, std::memory_order_relaxed);
+        }
+
+        /// @brief Whether the search is a ponder search still waiting for its ponder hit.
+        bool isPondering() const
+        {
+            return shared.isPondering();
+        }
+
+        /// @brief Nodes searched so far by all threads, updated every 1024 nodes per thread.
+        uint64_t nodes() const
+        {
+            return shared.nodes.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Move picker counters summed over all threads.
+        PickerStats moveStats() const
+        {
+            PickerStats total;
+            for (const std::unique_ptr<Searcher> &searcher : searchers)
+            {
+                total.nodes += searcher->pickerStats.nodes;
+                total.generated += searcher->pickerStats.generated;
+                total.picked += searcher->pickerStats.picked;
+                total.cutoffs += searcher->pickerStats.cutoffs;
+                total.firstMoveCutoffs += searcher->pickerStats.firstMoveCutoffs;
+            }
+            return total;
+        }
+
+    private:
+        TranspositionTable &tt;
+        std::vector<std::unique_ptr<Searcher>> searchers;
+        SharedState shared;
+        Options options;
+    };
+}
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "LargePages.h"
+#include "Move.h"
+
+/// @class TranspositionTable
+/// @brief Search results keyed by Zobrist key, shared by every search thread without locks.
+///
+/// The table is an array of 64-byte clusters, one cache line each, holding four entries.
+/// A position can live in any entry of its cluster, so a probe costs a single cache miss.
+/// Like Perft::PerftTable, each entry is stored as two atomic words, the packed data and
+/// the key XOR'ed with it: an entry torn by two threads writing at once fails the key
+/// check and reads as a miss.
+///
+/// The clusters live in huge pages when the system provides them (see LargePages), since
+/// nearly every probe of a large table otherwise also misses the TLB.
+class TranspositionTable
+{
+public:
+    // What the stored score says about the exact score of the position
+    enum Bound : uint8_t
+    {
+        BoundNone = 0,  /* Empty entry */
+        BoundUpper = 1, /* Failed low: score is at most the stored one */
+        BoundLower = 2, /* Failed high: score is at least the stored one */
+        BoundExact = 3
+    };
+
+    /// @struct Data
+    /// @brief Unpacked contents of an entry.
+    struct Data
+    {
+        Move move;   /* Best or refutation move, NullMove if none */
+        int score;   /* Search score, relative to the node (see Search::scoreToTT) */
+        int eval;    /* Static evaluation of the position */
+        int depth;   /* Remaining depth the score was searched with */
+        Bound bound;
+    };
+
+    // Bias added to the depth so depths down to this value fit the unsigned 8-bit field;
+    // stored depths are clamped to [DepthOffset, DepthOffset + 255]
+    static constexpr int DepthOffset = -8;
+    static constexpr int ClusterSize = 4;
+
+    TranspositionTable() = default;
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    /// @brief Allocates the table and clears it. Any size works, not only powers of two.
+    ///
+    /// @param megabytes: Table size in MiB, at least 1.
+    /// @return False if the memory cannot be allocated; the table is then empty.
+    bool resize(size_t megabytes)
+    {
+        clusterCount = 0;
+        size_t count = megabytes * 1024 * 1024 / sizeof(Cluster);
+        if (!clusters.allocate(count ? count : 1))
+            return false;
+        clusterCount = clusters.size();
+        clear();
+        return true;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < clusterCount; i++)
+        {
+            for (Entry &entry : clusters[i].entries)
+            {
+                entry.check.store(0, std::memory_order_relaxed);
+                entry.data.store(0, std::memory_order_relaxed);
+            }
+        }
+        generation = 0;
+    }
+
+    /// @brief Starts a new search. Entries of earlier searches stay usable but become the
+    /// first to be replaced, so the table ages without being cleared.
+    void newSearch()
+    {
+        generation = (generation + 1) & GenerationMask;
+    }
+
+    /// @brief Starts loading the cluster of a key into the cache ahead of the probe.
+    void prefetch(uint64_t key) const
+    {
+#if defined(__GNUC__)
+        __builtin_prefetch(&clusters[index(key)]);
+#endif
+    }
+
+    /// @brief Looks up a position.
+    ///
+    /// @param key: Zobrist key of the position.
+    /// @param data: Receives the entry on a hit.
+    /// @return True on a hit.
+    bool probe(uint64_t key, Data &data) const
+    {
+        const Cluster &cluster = clusters[index(key)];
+        for (const Entry &entry : cluster.entries)
+        {
+            uint64_t packed = entry.data.load(std::memory_order_relaxed);
+            uint64_t check = entry.check.load(std::memory_order_relaxed);
+            if ((check ^ packed) == key && boundOf(packed) != BoundNone)
+            {
+                data = unpack(packed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Stores a search result. An entry of the same position is overwritten unless it
+    /// holds a deeper exact result of the current search; otherwise the entry least worth
+    /// keeping is replaced, counting every search of age as eight plies of depth.
+    ///
+    /// @param move: Best move, or NullMove to keep the move already stored for the position.
+    void store(uint64_t key, int depth, int score, int eval, Bound bound, Move move)
+    {
+        Cluster &cluster = clusters[index(key)];
+        Entry *replace = nullptr;
+        Entry *victim = &cluster.entries[0];
+        int victimWorth = INT32_MAX;
+        for (Entry &entry : cluster.entries)
+        {
+            uint64_t packed = entry.data.load(std::memory_order_relaxed);
+            uint64_t check = entry.check.load(std::memory_order_relaxed);
+            if (boundOf(packed) != BoundNone && (check ^ packed) == key)
+            {
+                Data old = unpack(packed);
+                if (move == NullMove)
+                    move = old.move;
+                if (bound != BoundExact && old.bound == BoundExact && old.depth > depth &&
+                    generationOf(packed) == generation)
+                    return;
+                replace = &entry;
+                break;
+            }
+
+            int age = (generation - generationOf(packed)) & GenerationMask;
+            int worth = boundOf(packed) == BoundNone ? INT32_MIN : depthOf(packed) - 8 * age;
+            if (worth < victimWorth)
+            {
+                victimWorth = worth;
+                victim = &entry;
+            }
+        }
+        if (!replace)
+            replace = victim;
+
+        uint64_t packed = pack(depth, score, eval, bound, move);
+        replace->check.store(key ^ packed, std::memory_order_relaxed);
+        replace->data.store(packed, std::memory_order_relaxed);
+    }
+
+    /// @brief Permille of entries written by the current search, estimated from the first
+    /// thousand clusters as engines report it ("hashfull").
+    int hashfull() const
+    {
+        size_t sample = clusterCount < 1000 ? clusterCount : 1000;
+        size_t used = 0;
+        for (size_t i = 0; i < sample; i++)
+        {
+            for (const Entry &entry : clusters[i].entries)
+            {
+                uint64_t packed = entry.data.load(std::memory_order_relaxed);
+                used += boundOf(packed) != BoundNone && generationOf(packed) == generation;
+            }
+        }
+        return sample ? (int)(used * 1000 / (sample * ClusterSize)) : 0;
+    }
+
+    size_t size() const
+    {
+        return clusterCount * ClusterSize;
+    }
+
+    size_t sizeInBytes() const
+    {
+        return clusterCount * sizeof(Cluster);
+    }
+
+    /// @brief Page size backing the table, to report at startup.
+    LargePages::Mode pageMode() const
+    {
+        return clusters.mode();
+    }
+
+private:
+    // Packed entry data, 64 bits:
+    // move 0-15, score 16-31, eval 32-47, depth - DepthOffset 48-55, bound 56-57, generation 58-63
+    static constexpr int GenerationMask = 63;
+
+    struct Entry
+    {
+        std::atomic<uint64_t> check; /* Key XOR data */
+        std::atomic<uint64_t> data;  /* Packed Data and generation */
+    };
+
+    struct alignas(64) Cluster
+    {
+        Entry entries[ClusterSize];
+    };
+
+    static_assert(sizeof(Cluster) == 64, "A cluster must fill exactly one cache line");
+
+    LargePages::Array<Cluster> clusters;
+    size_t clusterCount = 0;
+    int generation = 0;
+
+    /// @brief Maps a key onto [0, clusterCount) with the high half of a 64x64 bit product,
+    /// which is uniform for any table size and cheaper than a modulo.
+    size_t index(uint64_t key) const
+    {
+#if defined(__SIZEOF_INT128__)
+        return (size_t)(((unsigned __int128)key * clusterCount) >> 64);
+#else
+        uint64_t keyLow = (uint32_t)key, keyHigh = key >> 32;
+        uint64_t countLow = (uint32_t)clusterCount, countHigh = (uint64_t)clusterCount >> 32;
+        uint64_t middle = keyHigh * countLow + ((keyLow * countLow) >> 32);
+        uint64_t cross = keyLow * countHigh + (uint32_t)middle;
+        return (size_t)(keyHigh * countHigh + (middle >> 32) + (cross >> 32));
+#endif
+    }
+
+    uint64_t pack(int depth, int score, int eval, Bound bound, Move move) const
+    {
+        depth = std::clamp(depth, DepthOffset, DepthOffset + 255);
+        return (uint64_t)move.data | (uint64_t)(uint16_t)(int16_t)score << 16 |
+               (uint64_t)(uint16_t)(int16_t)eval << 32 | (uint64_t)(uint8_t)(depth - DepthOffset) << 48 |
+               (uint64_t)bound << 56 | (uint64_t)generation << 58;
+    }
+
+    static Data unpack(uint64_t packed)
+    {
+        Data data;
+        data.move.data = (uint16_t)packed;
+        data.score = (int16_t)(packed >> 16);
+        data.eval = (int16_t)(packed >> 32);
+        data.depth = depthOf(packed);
+        data.bound = boundOf(packed);
+        return data;
+    }
+
+    static int depthOf(uint64_t packed)
+    {
+        return (int)((packed >> 48) & 0xFF) + DepthOffset;
+    }
+
+    static Bound boundOf(uint64_t packed)
+    {
+        return (Bound)((packed >> 56) & 3);
+    }
+
+    static int generationOf(uint64_t packed)
+    {
+        return (int)(packed >> 58);
+    }
+};
+
+#endif
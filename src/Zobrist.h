@@ -0,0 +1,65 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+#include "Bitboard.h"
+#include "Piece.h"
+
+namespace Zobrist
+{
+    /// @struct Keys
+    /// @brief Random 64-bit numbers XOR'ed together to form a position key.
+    struct Keys
+    {
+        uint64_t piece[2][7][64]; /* Indexed by Piece::colorIndex, piece type and square */
+        uint64_t castling[16];    /* Indexed by the Castling:: bit set */
+        uint64_t epFile[8];       /* File of the en passant square */
+        uint64_t blackToMove;
+    };
+
+    /// @brief SplitMix64 step, usable at compile time.
+    constexpr uint64_t nextRandom(uint64_t &state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    constexpr Keys makeKeys()
+    {
+        Keys keys{};
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        for (int color = 0; color < 2; color++)
+            for (int type = 0; type < 7; type++)
+                for (int square = 0; square < 64; square++)
+                    keys.piece[color][type][square] = type == Piece::None ? 0 : nextRandom(state);
+
+        // Castling keys are the XOR of one key per right, so updating a subset of rights
+        // is a single XOR of the old and new entries
+        uint64_t rightKeys[4] = {nextRandom(state), nextRandom(state), nextRandom(state), nextRandom(state)};
+        for (int rights = 0; rights < 16; rights++)
+        {
+            keys.castling[rights] = 0;
+            for (int bit = 0; bit < 4; bit++)
+                if (rights & (1 << bit))
+                    keys.castling[rights] ^= rightKeys[bit];
+        }
+
+        for (int file = 0; file < 8; file++)
+            keys.epFile[file] = nextRandom(state);
+        keys.blackToMove = nextRandom(state);
+        return keys;
+    }
+
+    // Generated at compile time, like the leaper attack tables
+    inline constexpr Keys keys = makeKeys();
+
+    /// @brief Key contribution of a piece standing on a square.
+    inline uint64_t pieceKey(int piece, int square)
+    {
+        return keys.piece[Piece::colorIndex(Piece::color(piece))][Piece::type(piece)][square];
+    }
+}
+
+#endif
@@ -1,15 +1,22 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
 #include <iostream>
 #include <glm/gtc/matrix_transform.hpp>
 #include <string>
-#include <unordered_map>
+#include <thread>
 
 #include "Shader.h"
 #include "Texture.h"
 #include "ShapeManager.h"
 #include "Board.h"
 #include "Piece.h"
+#include "MoveGen.h"
+#include "Fen.h"
+#include "See.h"
+#include "Search.h"
+#include "EngineThread.h"
+#include "TranspositionTable.h"
 
 // -----------------------------------------------
 // STRUCTS
@@ -31,34 +38,65 @@ struct PieceStruct
 // -----------------------------------------------
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods);
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
 void processInput(GLFWwindow *window);
 void renderPieces(Shader &shader, ShapeManager &quad, int quadIndex);
 void initializePieces(Texture textures[]);
-void parseFenString(const std::string &fenString, Board &board, Texture textures[]);
+void updatePieces();
 Texture *getTexture(int pieceType, Texture textures[]);
 void printPieceData();
+void checkValidMoves(int selectedIndex);
+void clearSelection();
+void startEngineMove();
+void startPondering(Move expectedReply);
+void stopPondering();
+void pollEngine(GLFWwindow *window);
 
 // -----------------------------------------------
 // GLOBAL VARIABLES
 // -----------------------------------------------
 #define SCR_WIDTH 800
 #define SCR_HEIGHT 800
-#define FEN_STRING "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR"
+#define FEN_STRING "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
 PieceStruct *selectedPiece = nullptr;
 std::vector<PieceStruct> pieces;
+Board chessBoard;                 // Position shown on screen
+Texture *pieceTextures = nullptr; // Textures used to rebuild pieces after a move
 glm::vec2 selectedCell = glm::vec2(1.0f, 1.0f);
 std::vector<glm::vec2> validMoves; // Set of valid cells to highlight for a selected piece
+MoveList selectedMoves;            // Legal moves of the selected piece
+int selectedSquare = -1;           // Board index of the selected piece, or -1
 bool isCellSelected = false;
+Bitboard hangingSquares = 0;       // Pieces of the side to move that lose material to a capture
+TranspositionTable transpositionTable;
+EngineThread *engine = nullptr;       // Opponent of the user, searching in the background with every core
+int engineColor = Piece::Black;       // Side the engine plays, switched with the space bar
+uint32_t engineSearchId = 0;          // Search whose move the UI is waiting for
+bool engineThinking = false;          // The user waits for the engine's move
+bool ponderEnabled = true;            // Think on the user's time, toggled with P
+uint32_t ponderSearchId = 0;          // Ponder search running while the user thinks, or 0
+Move ponderMove = NullMove;           // Reply of the user the ponder search expects
+double userMoveTime = 0.0;            // glfwGetTime() of the user's last move
+#define ENGINE_MOVE_TIME 1000         // Thinking time per engine move in milliseconds
+#define ENGINE_HASH_MB 64             // Transposition table size in MiB
+// Longest game the UI plays, leaving the rest of the board's undo stack to the engine's search
+#define MAX_GAME_PLIES (Board::MaxHistory - Search::MaxPly)
 
-void checkValidMoves()
+int main()
 {
-    if (selectedPiece->pieceType == Piece::Pawn)
+    // Precompute attack tables used by the move generator
+    Attacks::init();
+    std::cout << "Slider attack tables: " << Magic::memoryUsage() / 1024 << " KiB, " << Magic::backendName() << " indexing" << std::endl;
+    if (!transpositionTable.resize(ENGINE_HASH_MB))
     {
-        // Move only forward
+        std::cerr << "Cannot allocate a " << ENGINE_HASH_MB << " MiB transposition table" << std::endl;
+        return -1;
     }
-}
-int main()
-{
+    std::cout << "Transposition table: " << transpositionTable.sizeInBytes() / (1024 * 1024) << " MiB in "
+              << LargePages::modeName(transpositionTable.pageMode()) << std::endl;
+    engine = new EngineThread(transpositionTable, std::max(1u, std::thread::hardware_concurrency()));
+    std::cout << "Engine threads: " << engine->threadCount() << std::endl;
+
     // -----------------------------------------------
     // INITIALIZE GLFW
     // -----------------------------------------------
@@ -71,7 +109,7 @@ int main()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     // Create window
-    GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Chess", NULL, NULL);
     if (window == NULL)
     {
         std::cerr << "Failed to create GLFW window" << std::endl;
@@ -82,6 +120,7 @@ int main()
     // Callback functions
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetKeyCallback(window, key_callback);
 
     // -----------------------------------------------
     // LOAD GLAD
@@ -190,68 +229,24 @@ int main()
         boardShader.use();
         boardShader.setVec2("selectedCell", selectedCell);
         boardShader.setBool("isCellSelected", isCellSelected);
+        boardShader.setUInt("hangingLow", (unsigned int)hangingSquares);
+        boardShader.setUInt("hangingHigh", (unsigned int)(hangingSquares >> 32));
         board.renderShape(boardIndex, 6, 6, GL_TRIANGLES);
         // Render pieces
         renderPieces(pieceShader, quad, quadIndex);
 
         glfwSwapBuffers(window);
         glfwPollEvents();
+        // Moves and progress of the engine thread, never waiting for it
+        pollEngine(window);
     }
 
+    // Stops and joins the engine thread
+    delete engine;
     glfwTerminate();
     return 0;
 }
 
-void parseFenString(const std::string &fenString, Board &board, Texture textures[])
-{
-    // Map FEN characters to piece types
-    static const std::unordered_map<char, int> fenToPiece = {
-        {'r', Piece::Rook | Piece::Black}, {'n', Piece::Knight | Piece::Black}, {'b', Piece::Bishop | Piece::Black}, {'q', Piece::Queen | Piece::Black}, {'k', Piece::King | Piece::Black}, {'p', Piece::Pawn | Piece::Black}, {'R', Piece::Rook | Piece::White}, {'N', Piece::Knight | Piece::White}, {'B', Piece::Bishop | Piece::White}, {'Q', Piece::Queen | Piece::White}, {'K', Piece::King | Piece::White}, {'P', Piece::Pawn | Piece::White}};
-
-    int squareIndex = 0; // Tracks the current square on the board
-
-    for (char fenChar : fenString)
-    {
-        if (fenChar == '/')
-        {
-            // Skip slashes (they separate ranks in FEN)
-            continue;
-        }
-        else if (std::isdigit(fenChar))
-        {
-            // Handle numbers (represent empty squares)
-            int emptySquares = fenChar - '0';
-            for (int i = 0; i < emptySquares; i++)
-            {
-                if (squareIndex >= 64)
-                {
-                    // Prevent out-of-bounds access
-                    break;
-                }
-                board.Square[squareIndex++] = Piece::None;
-            }
-        }
-        else
-        {
-            // Handle piece characters
-            auto it = fenToPiece.find(fenChar);
-            if (it != fenToPiece.end())
-            {
-                if (squareIndex >= 64)
-                {
-                    // Prevent out-of-bounds access
-                    break;
-                }
-                board.Square[squareIndex++] = it->second;
-            }
-            else
-            {
-                std::cerr << "Invalid FEN character: " << fenChar << std::endl;
-            }
-        }
-    }
-}
-
 Texture *getTexture(int pieceType, Texture textures[])
 {
     // Check if the piece is black or white
@@ -308,10 +303,17 @@ Texture *getTexture(int pieceType, Texture textures[])
 
 void initializePieces(Texture textures[])
 {
-    pieces.clear();
+    pieceTextures = textures;
 
-    Board chessBoard;
-    parseFenString(FEN_STRING, chessBoard, textures);
+    chessBoard = Board();
+    parseFenString(FEN_STRING, chessBoard);
+
+    updatePieces();
+}
+
+void updatePieces()
+{
+    pieces.clear();
 
     for (int i = 0; i < 64; i++)
     {
@@ -325,7 +327,7 @@ void initializePieces(Texture textures[])
         // Get piece type
         int pieceType = chessBoard.Square[i];
         // Get texture from piece type
-        Texture *pieceTexture = getTexture(pieceType, textures);
+        Texture *pieceTexture = getTexture(pieceType, pieceTextures);
 
         // Store the piece in the vector
         if (pieceTexture != nullptr)
@@ -333,6 +335,8 @@ void initializePieces(Texture textures[])
         else
             pieces.emplace_back(Piece::None, glm::vec2(x, y), nullptr);
     }
+
+    hangingSquares = See::hangingPieces(chessBoard, chessBoard.sideToMove);
 }
 
 void renderPieces(Shader &shader, ShapeManager &quad, int quadIndex)
@@ -427,6 +431,42 @@ void processInput(GLFWwindow *window)
         glfwSetWindowShouldClose(window, true);
 }
 
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
+{
+    // Take back the last move
+    if ((key == GLFW_KEY_BACKSPACE || key == GLFW_KEY_U) && action == GLFW_PRESS && chessBoard.historySize > 0)
+    {
+        // The engine was answering, or pondering after, the move being taken back
+        if (engineThinking)
+        {
+            engine->stop();
+            engineThinking = false;
+            engineSearchId = 0;
+        }
+        stopPondering();
+        chessBoard.unmakeMove();
+        clearSelection();
+        updatePieces();
+    }
+
+    // Let the engine take over the side to move
+    if (key == GLFW_KEY_SPACE && action == GLFW_PRESS && !engineThinking)
+    {
+        stopPondering();
+        engineColor = chessBoard.sideToMove;
+        userMoveTime = glfwGetTime();
+        startEngineMove();
+    }
+
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        ponderEnabled = !ponderEnabled;
+        if (!ponderEnabled)
+            stopPondering();
+        std::cout << "Pondering " << (ponderEnabled ? "on" : "off") << std::endl;
+    }
+}
+
 void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 {
     glViewport(0, 0, width, height);
@@ -434,7 +474,8 @@ void framebuffer_size_callback(GLFWwindow *window, int width, int height)
 
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 {
-    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+    // The board belongs to the engine until it has moved
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && !engineThinking)
     {
         selectedPiece = nullptr;
 
@@ -450,13 +491,45 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
 
         // Get the index of the selected square
         int selectedIndex = y * 8 + x;
+
+        // Clicking a highlighted cell plays the move of the selected piece
+        for (const Move &move : selectedMoves)
+        {
+            // Promotions are generated queen first, so the first match promotes to a queen
+            if (move.to() == selectedIndex)
+            {
+                if (chessBoard.historySize >= MAX_GAME_PLIES)
+                {
+                    std::cout << "The game has reached " << MAX_GAME_PLIES << " plies; take back a move to go on" << std::endl;
+                    return;
+                }
+                chessBoard.makeMove(move);
+                clearSelection();
+                updatePieces();
+                userMoveTime = glfwGetTime();
+
+                // Ponder hit: the engine already searched this position and goes on with it
+                if (ponderSearchId && move == ponderMove && chessBoard.sideToMove == engineColor)
+                {
+                    engine->ponderHit();
+                    engineSearchId = ponderSearchId;
+                    engineThinking = true;
+                    ponderSearchId = 0;
+                    return;
+                }
+                stopPondering();
+                if (chessBoard.sideToMove == engineColor)
+                    startEngineMove();
+                return;
+            }
+        }
+
         // Set the selected piece
         selectedPiece = &pieces[selectedIndex];
         // If empty cells are selected
         if ((selectedPiece->pieceType & 7) == Piece::None)
         {
-            selectedPiece = nullptr;
-            isCellSelected = false;
+            clearSelection();
         }
         else
         {
@@ -468,28 +541,123 @@ void mouse_button_callback(GLFWwindow *window, int button, int action, int mods)
             isCellSelected = true;
 
             // Check the valid moves for the selected piece
-            if (selectedPiece != nullptr)
-            {
-                validMoves.clear();
-                float multiplier = (selectedPiece->pieceColor == Piece::White) ? 1.0f : -1.0f;
+            checkValidMoves(selectedIndex);
+        }
+    }
+}
 
-                // If selected piece is pawn
-                if ((selectedPiece->pieceType & 7) == Piece::Pawn)
-                {
-                    selectedCell.y += 1.0f * multiplier;
-                    validMoves.emplace_back(selectedCell);
-                }
+void checkValidMoves(int selectedIndex)
+{
+    validMoves.clear();
+    selectedMoves.clear();
+    selectedSquare = selectedIndex;
 
-                // If selected piece is rook
-                else if ((selectedPiece->pieceType & 7) == Piece::Rook)
-                {
-                    for (int i = (int)selectedCell.y + 1; i < 7; i++)
-                    {
-                        selectedCell.y += 1.0f * multiplier;
-                        validMoves.emplace_back(selectedCell);
-                    }
-                }
-            }
+    MoveList moves;
+    MoveGen::generateLegal(chessBoard, moves);
+
+    // Convert the destination squares of the selected piece to cell coordinates
+    for (const Move &move : moves)
+    {
+        if (move.from() != selectedIndex)
+            continue;
+        selectedMoves.push_back(move);
+
+        glm::vec2 cell = glm::vec2(move.to() % 8, 7 - move.to() / 8);
+        // Promotions produce the same destination four times
+        if (validMoves.empty() || validMoves.back() != cell)
+            validMoves.emplace_back(cell);
+    }
+}
+
+void clearSelection()
+{
+    selectedPiece = nullptr;
+    selectedSquare = -1;
+    isCellSelected = false;
+    validMoves.clear();
+    selectedMoves.clear();
+}
+
+void startEngineMove()
+{
+    MoveList moves;
+    MoveGen::generateLegal(chessBoard, moves);
+    if (moves.empty() || chessBoard.isDraw() || chessBoard.historySize >= MAX_GAME_PLIES)
+        return;
+
+    Search::Limits limits;
+    limits.moveTimeMs = ENGINE_MOVE_TIME;
+    engineSearchId = engine->go(chessBoard, limits);
+    engineThinking = true;
+}
+
+void pollEngine(GLFWwindow *window)
+{
+    EngineEvent event;
+    while (engine->poll(event))
+    {
+        // Events of a search cancelled by a take back, or of a ponder miss
+        bool ponderEvent = ponderSearchId && event.searchId == ponderSearchId;
+        if (event.searchId != engineSearchId && !ponderEvent)
+            continue;
+
+        std::string line = "depth " + std::to_string(event.depth) + ", " + Search::scoreToString(event.score) +
+                           ", " + std::to_string(event.nodes) + " nodes:";
+        for (int i = 0; i < event.pvLength; i++)
+            line += " " + moveToString(event.pv[i]);
+
+        if (event.type == EngineEvent::Info)
+        {
+            std::string state = ponderEvent ? "pondering on " + moveToString(ponderMove) : "thinking";
+            glfwSetWindowTitle(window, ("Chess - " + state + ", " + line).c_str());
+            continue;
+        }
+        if (ponderEvent)
+            continue;
+
+        glfwSetWindowTitle(window, ("Chess - " + line).c_str());
+        if (engineThinking && !event.pondering && event.bestMove != NullMove)
+        {
+            std::cout << "Engine: " << line << " (answered in " << glfwGetTime() - userMoveTime << " s)" << std::endl;
+            engineThinking = false;
+            chessBoard.makeMove(event.bestMove);
+            clearSelection();
+            updatePieces();
+            startPondering(event.ponderMove);
         }
     }
 }
+
+void startPondering(Move expectedReply)
+{
+    // The expected reply is one more game ply
+    if (!ponderEnabled || expectedReply == NullMove || chessBoard.historySize + 1 >= MAX_GAME_PLIES)
+        return;
+
+    // The reply comes from the PV, which may be cut short or stale; only ponder on legal moves
+    MoveList moves;
+    MoveGen::generateLegal(chessBoard, moves);
+    if (!moves.contains(expectedReply))
+        return;
+
+    Board expected = chessBoard;
+    expected.makeMove(expectedReply);
+    MoveList replies;
+    MoveGen::generateLegal(expected, replies);
+    if (replies.empty() || expected.isDraw())
+        return;
+
+    Search::Limits limits;
+    limits.moveTimeMs = ENGINE_MOVE_TIME;
+    ponderMove = expectedReply;
+    ponderSearchId = engine->ponder(expected, limits);
+}
+
+void stopPondering()
+{
+    if (!ponderSearchId)
+        return;
+    engine->stop();
+    ponderSearchId = 0;
+    ponderMove = NullMove;
+}
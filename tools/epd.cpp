@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Board.h"
+#include "EpdReader.h"
+#include "Fen.h"
+
+// -----------------------------------------------
+// STRUCTS
+// -----------------------------------------------
+struct ShardStats
+{
+    uint64_t records = 0;
+    uint64_t invalid = 0;
+    uint64_t checksum = 0; // XOR of the keys of every valid position
+};
+
+// -----------------------------------------------
+// FUNCTION PROTOTYPES
+// -----------------------------------------------
+void printUsage();
+ShardStats readShard(std::string_view data, Epd::Range range);
+
+// -----------------------------------------------
+// GLOBAL VARIABLES
+// -----------------------------------------------
+bool fenRecords = false;     // Parse lines as FEN (with clocks) instead of EPD
+std::mutex errorMutex;       // Serializes error reports of the shards
+std::atomic<int> errorsShown(0);
+constexpr int MaxErrorsShown = 10;
+
+int main(int argc, char *argv[])
+{
+    const char *path = nullptr;
+    int threadCount = 1;
+
+    // -----------------------------------------------
+    // PARSE ARGUMENTS
+    // -----------------------------------------------
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--fen") == 0)
+            fenRecords = true;
+        else if (argv[i][0] != '-' && !path)
+            path = argv[i];
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (!path)
+    {
+        printUsage();
+        return 1;
+    }
+
+    // Parsing tests whether the side not to move is in check, which needs the slider tables
+    Attacks::init();
+
+    MappedFile file;
+    if (!file.open(path))
+        return 1;
+    std::string_view data = file.data();
+
+    // -----------------------------------------------
+    // READ SHARDS
+    // -----------------------------------------------
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<ShardStats> shards(threadCount);
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threadCount; t++)
+        pool.emplace_back([&, t]() { shards[t] = readShard(data, Epd::shard(data, t, threadCount)); });
+    shards[0] = readShard(data, Epd::shard(data, 0, threadCount));
+    for (std::thread &thread : pool)
+        thread.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ShardStats total;
+    for (const ShardStats &shard : shards)
+    {
+        total.records += shard.records;
+        total.invalid += shard.invalid;
+        total.checksum ^= shard.checksum;
+    }
+
+    seconds = std::max(seconds, 1e-9);
+    std::cout << "Records: " << total.records << " (" << total.invalid << " invalid), checksum "
+              << std::hex << total.checksum << std::dec << "\n"
+              << "Read " << data.size() / (1024 * 1024) << " MiB in " << seconds << " s with " << threadCount << " thread(s): "
+              << (uint64_t)(total.records / seconds) << " positions/s, "
+              << (uint64_t)(data.size() / seconds / (1024 * 1024)) << " MiB/s" << std::endl;
+    return total.invalid ? 2 : 0;
+}
+
+void printUsage()
+{
+    std::cerr << "Usage: epd <file> [--threads N] [--fen]\n"
+              << "  Parses every line of an EPD file (or FEN lines with --fen) and reports throughput." << std::endl;
+}
+
+ShardStats readShard(std::string_view data, Epd::Range range)
+{
+    ShardStats stats;
+    Board board;
+    std::string_view operations;
+
+    auto parseLine = [&](std::string_view line, size_t offset)
+    {
+        Fen::Result result = fenRecords ? Fen::parse(line, board) : Fen::parseEpd(line, board, operations);
+        stats.records++;
+        if (result)
+        {
+            stats.checksum ^= board.key;
+            return;
+        }
+
+        stats.invalid++;
+        if (errorsShown.fetch_add(1) < MaxErrorsShown)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            std::cerr << "Byte " << offset + result.offset << ": " << Fen::errorMessage(result.error)
+                      << " in \"" << line << "\"" << std::endl;
+        }
+    };
+
+    Epd::forEachLine(data, range, parseLine);
+    return stats;
+}
@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "Board.h"
+#include "Fen.h"
+#include "Perft.h"
+
+// -----------------------------------------------
+// STRUCTS
+// -----------------------------------------------
+struct BenchPosition
+{
+    const char *fen;
+    int depth;
+    uint64_t expectedNodes;
+};
+
+struct FenCase
+{
+    const char *fen;
+    Fen::Error expected;
+};
+
+// -----------------------------------------------
+// FUNCTION PROTOTYPES
+// -----------------------------------------------
+void printUsage();
+double secondsSince(std::chrono::steady_clock::time_point start);
+uint64_t runPerft(Board &board, int depth, bool divide, bool report);
+void printThreadStats(const Perft::ParallelResult &result);
+bool checkFenCases();
+int runBench();
+int runCompare();
+
+// -----------------------------------------------
+// GLOBAL VARIABLES
+// -----------------------------------------------
+int threadCount = 1; // Perft threads, 1 runs the plain recursive perft
+int splitDepth = 1;  // Plies expanded before handing subtrees to threads
+Perft::PerftTable hashTable;
+bool useHash = false;
+
+// Reference positions with well-known node counts, covering castling, en passant,
+// promotions and discovered checks
+const BenchPosition benchPositions[] = {
+    {START_FEN, 6, 119060324},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5, 193690690},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594}};
+
+// Inputs the FEN parser has to accept or reject, checked before the bench. A rejected
+// FEN must leave the board untouched
+const FenCase fenCases[] = {
+    {"rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", Fen::Ok},
+    {"4k3/8/8/8/3p4/8/8/4K3 b - e3 0 1", Fen::BadEnPassant},    // No pawn in front of the square
+    {"4k3/8/8/8/3pP3/8/4P3/4K3 b - e3 0 1", Fen::BadEnPassant}, // The pawn's origin is occupied
+    {"4k3/8/8/8/3pP3/4N3/8/4K3 b - e3 0 1", Fen::BadEnPassant}, // The square itself is occupied
+    {"4k3/8/8/8/3pp3/8/8/4K3 b - e3 0 1", Fen::BadEnPassant},   // The pawn in front is the mover's
+    {"4k3/8/8/8/8/8/8/4R1K1 b - - 0 1", Fen::Ok},
+    {"4k3/8/8/8/8/8/8/4R1K1 w - - 0 1", Fen::OpponentInCheck},  // White to move could take the king
+    {"4k3/8/8/8/8/8/8/P3K3 w - - 0 1", Fen::BadPawnRank},       // Pawn on the first rank
+    {"p3k3/8/8/8/8/8/8/4K3 w - - 0 1", Fen::BadPawnRank},       // Pawn on the last rank
+    {"4k3/8/8/8/8/8/8/4K3 w - - x 1", Fen::BadHalfmoveClock},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 0 -1", Fen::BadFullmoveNumber},
+    {"4k3/8/8/8/8/8/8/4K3 w - - 0 1 x", Fen::TrailingText}};
+
+int main(int argc, char *argv[])
+{
+    std::string fen = START_FEN;
+    int depth = 5;
+    bool divide = false;
+    bool bench = false;
+    bool compare = false;
+    Magic::Backend backend = Magic::Auto;
+
+    // -----------------------------------------------
+    // PARSE ARGUMENTS
+    // -----------------------------------------------
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--fen") == 0 && i + 1 < argc)
+            fen = argv[++i];
+        else if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+        {
+            // Digits only: a negative depth would recurse until the undo stack overflows
+            if (!Fen::parseNumber(argv[++i], depth) || depth > Board::MaxHistory)
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--divide") == 0)
+            divide = true;
+        else if (std::strcmp(argv[i], "--bench") == 0)
+            bench = true;
+        else if (std::strcmp(argv[i], "--compare") == 0)
+            compare = true;
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--split") == 0 && i + 1 < argc)
+            splitDepth = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--hash") == 0 && i + 1 < argc)
+        {
+            int megabytes = std::atoi(argv[++i]);
+            useHash = megabytes > 0;
+            if (useHash && !hashTable.resize(megabytes))
+            {
+                std::cerr << "Cannot allocate a " << megabytes << " MiB hash table" << std::endl;
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--backend") == 0 && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+            backend = name == "magic" ? Magic::Multiply : name == "pext" ? Magic::Pext : Magic::Auto;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    Magic::init(backend);
+    std::cout << "Slider attack tables: " << Magic::memoryUsage() / 1024 << " KiB, " << Magic::backendName() << " indexing" << std::endl;
+    if (useHash)
+        std::cout << "Hash table: " << hashTable.sizeInBytes() / (1024 * 1024) << " MiB in "
+                  << LargePages::modeName(hashTable.pageMode()) << std::endl;
+
+    if (bench)
+        return runBench();
+    if (compare)
+        return runCompare();
+
+    // -----------------------------------------------
+    // RUN PERFT
+    // -----------------------------------------------
+    Board board;
+    if (!parseFenString(fen, board))
+        return 1;
+    std::cout << "Position: " << fen << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = runPerft(board, depth, divide, true);
+    double seconds = secondsSince(start);
+
+    std::cout << "Depth " << depth << ": " << nodes << " nodes in " << seconds << " s ("
+              << (uint64_t)(nodes / (seconds > 0 ? seconds : 1e-9)) << " nodes/s)" << std::endl;
+    return 0;
+}
+
+void printUsage()
+{
+    std::cerr << "Usage: perft [--fen \"<fen>\"] [--depth N] [--divide] [--threads N] [--split N] [--hash MiB] [--backend auto|magic|pext]\n"
+              << "       perft --bench [--threads N] [--split N] [--hash MiB] [--backend auto|magic|pext]\n"
+              << "       perft --compare [--backend auto|magic|pext]" << std::endl;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t runPerft(Board &board, int depth, bool divide, bool report)
+{
+    if ((threadCount == 1 && !useHash) || depth < 2)
+        return divide ? Perft::divide(board, depth) : Perft::perft(board, depth);
+
+    Perft::ParallelResult result = Perft::perftParallel(board, depth, threadCount, splitDepth, useHash ? &hashTable : nullptr);
+    if (divide)
+    {
+        for (size_t i = 0; i < result.rootMoves.size(); i++)
+            std::cout << moveToString(result.rootMoves[i]) << ": " << result.rootNodes[i] << "\n";
+    }
+    if (report)
+        printThreadStats(result);
+    return result.nodes;
+}
+
+void printThreadStats(const Perft::ParallelResult &result)
+{
+    uint64_t maxNodes = 0;
+    for (size_t t = 0; t < result.threads.size(); t++)
+    {
+        std::cout << "Thread " << t << ": " << result.threads[t].nodes << " nodes, "
+                  << result.threads[t].tasks << " subtrees" << std::endl;
+        maxNodes = std::max(maxNodes, result.threads[t].nodes);
+    }
+
+    // 1.0 means every thread counted the same number of nodes
+    double average = (double)result.nodes / result.threads.size();
+    std::cout << "Imbalance (busiest / average): " << (average > 0 ? maxNodes / average : 1.0) << std::endl;
+
+    if (useHash)
+    {
+        uint64_t probes = 0, hits = 0;
+        for (const Perft::ThreadStats &stats : result.threads)
+        {
+            probes += stats.probes;
+            hits += stats.hits;
+        }
+        size_t used = hashTable.usedEntries();
+        std::cout << "Hash: " << hashTable.sizeInBytes() / (1024 * 1024) << " MiB, "
+                  << used << " of " << hashTable.size() << " entries used ("
+                  << 100.0 * used / hashTable.size() << "%), "
+                  << hits << " hits of " << probes << " probes ("
+                  << (probes ? 100.0 * hits / probes : 0.0) << "%)" << std::endl;
+    }
+}
+
+bool checkFenCases()
+{
+    bool allPassed = true;
+    for (const FenCase &fenCase : fenCases)
+    {
+        Board board;
+        const std::string before = Fen::toString(board);
+        Fen::Error error = Fen::parse(fenCase.fen, board).error;
+        bool passed = error == fenCase.expected && (error == Fen::Ok || Fen::toString(board) == before);
+        allPassed = allPassed && passed;
+        std::cout << (passed ? "[ OK ] " : "[FAIL] ") << fenCase.fen << ": " << Fen::errorMessage(error)
+                  << " (expected " << Fen::errorMessage(fenCase.expected) << ")" << std::endl;
+    }
+    return allPassed;
+}
+
+int runBench()
+{
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0.0;
+    bool allPassed = checkFenCases();
+
+    for (const BenchPosition &position : benchPositions)
+    {
+        Board board;
+        parseFenString(position.fen, board);
+        if (useHash)
+            hashTable.clear();
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = runPerft(board, position.depth, false, false);
+        double seconds = secondsSince(start);
+
+        bool passed = nodes == position.expectedNodes;
+        allPassed = allPassed && passed;
+        totalNodes += nodes;
+        totalSeconds += seconds;
+
+        std::cout << (passed ? "[ OK ] " : "[FAIL] ") << position.fen << " depth " << position.depth
+                  << ": " << nodes << " (expected " << position.expectedNodes << ") "
+                  << seconds << " s" << std::endl;
+    }
+
+    std::cout << "Total: " << totalNodes << " nodes in " << totalSeconds << " s ("
+              << (uint64_t)(totalNodes / totalSeconds) << " nodes/s)" << std::endl;
+    return allPassed ? 0 : 1;
+}
+
+int runCompare()
+{
+    // Single-threaded and unhashed, so only the generators differ
+    struct Variant
+    {
+        const char *name;
+        uint64_t (*perft)(Board &, int);
+        double seconds;
+    };
+    Variant variants[] = {
+        {"Color-templated", Perft::perft<MoveGen::generateLegal>, 0.0},
+        {"Runtime color", Perft::perft<MoveGen::generateLegalRuntime>, 0.0},
+        {"Pseudo + filter", Perft::perft<MoveGen::generateLegalFiltered>, 0.0},
+    };
+    uint64_t totalNodes = 0;
+    bool allPassed = true;
+
+    for (const BenchPosition &position : benchPositions)
+    {
+        Board board;
+        parseFenString(position.fen, board);
+
+        bool passed = true;
+        std::ostringstream times;
+        for (Variant &variant : variants)
+        {
+            auto start = std::chrono::steady_clock::now();
+            passed = variant.perft(board, position.depth) == position.expectedNodes && passed;
+            double seconds = secondsSince(start);
+            variant.seconds += seconds;
+            times << " " << seconds;
+        }
+        allPassed = allPassed && passed;
+        totalNodes += position.expectedNodes;
+
+        std::cout << (passed ? "[ OK ] " : "[FAIL] ") << position.fen << " depth " << position.depth
+                  << ":" << times.str() << " s" << std::endl;
+    }
+
+    for (const Variant &variant : variants)
+    {
+        std::cout << std::left << std::setw(16) << variant.name << (uint64_t)(totalNodes / variant.seconds)
+                  << " nodes/s, " << variant.seconds / variants[0].seconds << "x the time" << std::endl;
+    }
+    return allPassed ? 0 : 1;
+}
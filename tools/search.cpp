@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "Board.h"
+#include "Fen.h"
+#include "Magic.h"
+#include "Search.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+// -----------------------------------------------
+// STRUCTS
+// -----------------------------------------------
+struct BenchPosition
+{
+    const char *fen;
+    int depth;
+};
+
+struct BenchTotals
+{
+    uint64_t nodes = 0;
+    double seconds = 0.0; // Time to reach the bench depths, summed over the positions
+};
+
+// -----------------------------------------------
+// FUNCTION PROTOTYPES
+// -----------------------------------------------
+void printUsage();
+void printIteration(const Search::Result &result);
+std::string pvToString(const MoveList &pv);
+BenchTotals runBench(bool report);
+int runScaling(int maxThreads);
+
+// -----------------------------------------------
+// GLOBAL VARIABLES
+// -----------------------------------------------
+TranspositionTable transpositionTable;
+size_t hashMegabytes = 16;
+Search::ThreadPool threads(transpositionTable);
+
+// Middlegame and endgame positions searched to a fixed depth, so node counts are
+// reproducible and comparable between builds
+const BenchPosition benchPositions[] = {
+    {START_FEN, 11},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 9},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 13},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 10},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 10},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 10},
+    {"6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", 10}};
+
+int main(int argc, char *argv[])
+{
+    std::string fen = START_FEN;
+    Search::Limits limits;
+    Search::Options options;
+    bool bench = false;
+    bool scaling = false;
+    int threadCount = 1;
+
+    // -----------------------------------------------
+    // PARSE ARGUMENTS
+    // -----------------------------------------------
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--fen") == 0 && i + 1 < argc)
+            fen = argv[++i];
+        else if (std::strcmp(argv[i], "--depth") == 0 && i + 1 < argc)
+            limits.depth = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--movetime") == 0 && i + 1 < argc)
+            limits.moveTimeMs = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--nodes") == 0 && i + 1 < argc)
+            limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--hash") == 0 && i + 1 < argc)
+            hashMegabytes = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--no-nmp") == 0)
+            options.nullMove = false;
+        else if (std::strcmp(argv[i], "--no-lmr") == 0)
+            options.lateMoveReductions = false;
+        else if (std::strcmp(argv[i], "--no-rfp") == 0)
+            options.reverseFutility = false;
+        else if (std::strcmp(argv[i], "--no-fp") == 0)
+            options.futility = false;
+        else if (std::strcmp(argv[i], "--bench") == 0)
+            bench = true;
+        else if (std::strcmp(argv[i], "--scaling") == 0)
+            scaling = true;
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    Magic::init();
+    if (!transpositionTable.resize(hashMegabytes))
+    {
+        std::cerr << "Cannot allocate a " << hashMegabytes << " MiB transposition table" << std::endl;
+        return 1;
+    }
+    std::cout << "Transposition table: " << transpositionTable.sizeInBytes() / (1024 * 1024) << " MiB, "
+              << transpositionTable.size() << " entries in " << LargePages::modeName(transpositionTable.pageMode()) << std::endl;
+    threads.setOptions(options);
+    if (scaling)
+        return runScaling(threadCount);
+    threads.setThreadCount(threadCount);
+    if (bench)
+    {
+        runBench(true);
+        return 0;
+    }
+
+    // Without any limit, search a sensible default instead of forever
+    if (limits.depth == Search::Limits().depth && !limits.moveTimeMs && !limits.nodes)
+        limits.depth = 8;
+
+    // -----------------------------------------------
+    // SEARCH
+    // -----------------------------------------------
+    Board board;
+    if (!parseFenString(fen, board))
+        return 1;
+    std::cout << "Position: " << fen << std::endl;
+
+    MoveList moves;
+    MoveGen::generateLegal(board, moves);
+    if (moves.empty())
+    {
+        std::cout << (board.inCheck() ? "Checkmate" : "Stalemate") << ", nothing to search" << std::endl;
+        return 0;
+    }
+
+    Search::Result result = threads.search(board, limits, printIteration);
+    std::cout << "bestmove " << moveToString(result.bestMove) << std::endl;
+    return 0;
+}
+
+void printUsage()
+{
+    std::cerr << "Usage: search [--fen \"<fen>\"] [--depth N] [--movetime ms] [--nodes N] [--threads N] [--hash MiB] [pruning]\n"
+              << "       search --bench [--threads N] [--hash MiB] [pruning]\n"
+              << "       search --scaling --threads N [--hash MiB] [pruning]\n"
+              << "  Searches a position and prints the principal variation of every iteration.\n"
+              << "  --bench searches fixed positions to fixed depths and reports nodes/s.\n"
+              << "  --scaling runs the bench with 1 to N threads and compares nodes/s and time to depth.\n"
+              << "  pruning: --no-nmp, --no-lmr, --no-rfp, --no-fp switch off null-move pruning, late move\n"
+              << "  reductions, reverse futility and futility pruning." << std::endl;
+}
+
+void printIteration(const Search::Result &result)
+{
+    double seconds = std::max(result.seconds, 1e-9);
+    std::cout << "info depth " << result.depth << " score " << Search::scoreToString(result.score)
+              << " nodes " << result.nodes << " nps " << (uint64_t)(result.nodes / seconds)
+              << " time " << (int64_t)(result.seconds * 1000) << " hashfull " << result.hashfull
+              << " tthits " << (result.ttProbes ? 100 * result.ttHits / result.ttProbes : 0) << "%"
+              << " pv " << pvToString(result.pv) << std::endl;
+}
+
+std::string pvToString(const MoveList &pv)
+{
+    std::string line;
+    for (const Move &move : pv)
+    {
+        if (!line.empty())
+            line += ' ';
+        line += moveToString(move);
+    }
+    return line;
+}
+
+BenchTotals runBench(bool report)
+{
+    BenchTotals totals;
+    uint64_t totalProbes = 0;
+    uint64_t totalHits = 0;
+    PickerStats totalStats;
+
+    for (const BenchPosition &position : benchPositions)
+    {
+        Board board;
+        parseFenString(position.fen, board);
+        // Every position starts from an empty table so node counts do not depend on the order
+        transpositionTable.clear();
+        threads.clearHistory();
+
+        Search::Limits limits;
+        limits.depth = position.depth;
+        Search::Result result = threads.search(board, limits);
+
+        PickerStats stats = threads.moveStats();
+        totalStats.nodes += stats.nodes;
+        totalStats.generated += stats.generated;
+        totalStats.picked += stats.picked;
+        totalStats.cutoffs += stats.cutoffs;
+        totalStats.firstMoveCutoffs += stats.firstMoveCutoffs;
+        totalProbes += result.ttProbes;
+        totalHits += result.ttHits;
+        totals.nodes += result.nodes;
+        totals.seconds += result.seconds;
+
+        if (report)
+            std::cout << position.fen << " depth " << result.depth << ": " << moveToString(result.bestMove)
+                      << " " << Search::scoreToString(result.score) << ", " << result.nodes << " nodes, "
+                      << result.seconds << " s, hashfull " << result.hashfull << std::endl;
+    }
+
+    totals.seconds = std::max(totals.seconds, 1e-9);
+    if (report)
+        std::cout << "Total: " << totals.nodes << " nodes in " << totals.seconds << " s ("
+                  << (uint64_t)(totals.nodes / totals.seconds) << " nodes/s) with " << threads.threadCount() << " thread(s)\n"
+                  << "Move picker: " << totalStats.picked << " of " << totalStats.generated
+                  << " generated moves searched over " << totalStats.nodes << " nodes, "
+                  << (totalStats.cutoffs ? 100.0 * totalStats.firstMoveCutoffs / totalStats.cutoffs : 0.0)
+                  << "% of " << totalStats.cutoffs << " cutoffs on the first move\n"
+                  << "Transposition table: " << totalHits << " hits in " << totalProbes << " probes ("
+                  << (totalProbes ? 100.0 * totalHits / totalProbes : 0.0) << "%)" << std::endl;
+    return totals;
+}
+
+int runScaling(int maxThreads)
+{
+    std::cout << "Threads   Nodes/s      Speedup   Time to depth   Speedup" << std::endl;
+    BenchTotals single;
+    for (int count = 1; count <= maxThreads; count++)
+    {
+        threads.setThreadCount(count);
+        BenchTotals totals = runBench(false);
+        if (count == 1)
+            single = totals;
+
+        double nps = totals.nodes / totals.seconds;
+        std::cout << std::left << std::setw(10) << count << std::setw(13) << (uint64_t)nps
+                  << std::setw(10) << std::fixed << std::setprecision(2) << nps / (single.nodes / single.seconds)
+                  << std::setw(16) << std::setprecision(3) << totals.seconds
+                  << std::setprecision(2) << single.seconds / totals.seconds << std::defaultfloat << std::right << std::endl;
+    }
+    return 0;
+}